@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace bench
+{
+	// fanout^1 + ... + fanout^depth folders holding filesPerDir small files each, built once and reused
+	inline fs::path makeTree( std::string_view name, size_t depth, size_t fanout, size_t filesPerDir )
+	{
+		const fs::path root = fs::temp_directory_path() / name;
+		const fs::path marker = root / ".complete";
+		if ( fs::exists( marker ) )
+		{
+			return root;
+		}
+
+		fs::remove_all( root );
+		std::function< void( const fs::path&, size_t ) > build = [ & ] ( const fs::path& dir, size_t level )
+		{
+			fs::create_directories( dir );
+			for ( size_t i = 0; i < filesPerDir; ++i )
+			{
+				std::ofstream( dir / ( "file" + std::to_string( i ) ) ) << std::string( 64 * ( i + 1 ), 'x' );
+			}
+			if ( level < depth )
+			{
+				for ( size_t i = 0; i < fanout; ++i )
+				{
+					build( dir / ( "dir" + std::to_string( i ) ), level + 1 );
+				}
+			}
+		};
+		build( root, 0 );
+		std::ofstream( marker ) << "";
+		return root;
+	}
+
+	// median of the runs in milliseconds, the first run only warms the caches
+	inline double measure( size_t runs, const std::function< void() >& body )
+	{
+		body();
+
+		std::vector< double > times;
+		for ( size_t i = 0; i < runs; ++i )
+		{
+			const auto start = std::chrono::steady_clock::now();
+			body();
+			times.push_back( std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count() );
+		}
+
+		std::sort( times.begin(), times.end() );
+		return times[ times.size() / 2 ];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "bench_tree.hpp"
+#include "core/io_scheduler.hpp"
+#include "utils/device_info.hpp"
+
+namespace
+{
+	constexpr size_t RUNS = 5;
+	constexpr size_t MAX_THREADS = 16;
+
+	// a cold cache is what a disk scan meets, the warm one only measures the CPU. needs root on Linux
+	void dropCaches( bool isEnabled )
+	{
+#ifndef _WIN32
+		if ( isEnabled )
+		{
+			std::fflush( nullptr );
+			if ( std::FILE* file = std::fopen( "/proc/sys/vm/drop_caches", "w" ) )
+			{
+				std::fputs( "3", file );
+				std::fclose( file );
+			}
+		}
+#endif
+	}
+
+	uint64_t walk( const fs::path& root )
+	{
+		uint64_t bytes = 0;
+		std::error_code ec;
+		for ( fs::recursive_directory_iterator it( root, ec ), end; it != end; it.increment( ec ) )
+		{
+			if ( it->is_regular_file( ec ) )
+			{
+				bytes += it->file_size( ec );
+				core::recordIoOperations();
+			}
+		}
+		return bytes;
+	}
+
+	// the scan before per-device scheduling: every thread takes the next option root in listing order
+	uint64_t walkWithThreads( const std::vector< fs::path >& roots, size_t threadCount )
+	{
+		std::atomic< size_t > next { 0 };
+		std::atomic< uint64_t > bytes { 0 };
+		std::vector< std::thread > threads;
+		for ( size_t i = 0; i < threadCount; ++i )
+		{
+			threads.emplace_back( [ & ] ()
+			{
+				for ( size_t index = next++; index < roots.size(); index = next++ )
+				{
+					bytes += walk( roots[ index ] );
+				}
+			} );
+		}
+		for ( std::thread& thread : threads )
+		{
+			thread.join();
+		}
+		return bytes;
+	}
+
+	uint64_t walkScheduled( const std::vector< fs::path >& roots )
+	{
+		std::atomic< uint64_t > bytes { 0 };
+		core::TaskGroup group;
+		core::IoScheduler scheduler( group );
+		std::vector< core::IoWork > works;
+		for ( const fs::path& root : roots )
+		{
+			works.push_back( { root, [ &bytes, root ] ()
+			{
+				bytes += walk( root );
+			} } );
+		}
+		scheduler.schedule( std::move( works ) );
+		group.wait();
+		return bytes;
+	}
+}
+
+// io_scheduler_bench [--drop-caches] [folder]: the subfolders of the folder are the option roots
+int main( int argc, char** argv )
+{
+	bool isDropCaches = false;
+	fs::path root;
+	for ( int i = 1; i < argc; ++i )
+	{
+		if ( std::strcmp( argv[ i ], "--drop-caches" ) == 0 )
+		{
+			isDropCaches = true;
+		}
+		else
+		{
+			root = argv[ i ];
+		}
+	}
+	if ( root.empty() )
+	{
+		root = bench::makeTree( "systemcleaner_bench_tree", 3, 16, 8 );
+	}
+
+	std::vector< fs::path > roots;
+	for ( const fs::directory_entry& entry : fs::directory_iterator( root ) )
+	{
+		if ( entry.is_directory() )
+		{
+			roots.push_back( entry.path() );
+		}
+	}
+
+	const std::optional< bool > isRotational = utils::isRotational( root );
+	std::printf( "%zu roots under %s, %s device, %s cache, median of %zu runs\n", roots.size(), root.string().c_str(),
+		!isRotational ? "unknown" : *isRotational ? "rotational" : "solid state", isDropCaches ? "cold" : "warm", RUNS );
+
+	uint64_t expected = 0;
+	for ( size_t threadCount = 1; threadCount <= MAX_THREADS; threadCount *= 2 )
+	{
+		const double time = bench::measure( RUNS, [ & ] ()
+		{
+			dropCaches( isDropCaches );
+			expected = walkWithThreads( roots, threadCount );
+		} );
+		std::printf( "%2zu threads, listing order:  %9.2f ms\n", threadCount, time );
+	}
+
+	uint64_t scheduled = 0;
+	const double time = bench::measure( RUNS, [ & ] ()
+	{
+		dropCaches( isDropCaches );
+		scheduled = walkScheduled( roots );
+	} );
+	std::printf( "IoScheduler:                 %9.2f ms\n", time );
+	return scheduled == expected ? 0 : 1;
+}
\ No newline at end of file
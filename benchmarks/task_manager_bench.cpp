@@ -0,0 +1,205 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "bench_tree.hpp"
+#include "core/task_manager.hpp"
+
+namespace
+{
+	constexpr size_t RUNS = 9;
+	// the task overhead case: a binary tree of empty tasks, 2^17 - 1 of them
+	constexpr size_t SPLIT_DEPTH = 16;
+
+	// the pool TaskManager replaced: one locked queue shared by every thread, waited on from outside
+	class SharedQueuePool
+	{
+	public:
+		explicit SharedQueuePool( size_t threadCount )
+		{
+			for ( size_t i = 0; i < threadCount; ++i )
+			{
+				m_threads.emplace_back( [ this ] ()
+				{
+					workerLoop();
+				} );
+			}
+		}
+
+		~SharedQueuePool()
+		{
+			{
+				std::scoped_lock lock( m_mutex );
+				m_isStopping = true;
+			}
+			m_wakeUp.notify_all();
+			for ( std::thread& thread : m_threads )
+			{
+				thread.join();
+			}
+		}
+
+		void run( std::function< void() > task )
+		{
+			{
+				std::scoped_lock lock( m_mutex );
+				m_tasks.push_back( std::move( task ) );
+				++m_pending;
+			}
+			m_wakeUp.notify_one();
+		}
+
+		void wait()
+		{
+			std::unique_lock lock( m_mutex );
+			m_done.wait( lock, [ this ] ()
+			{
+				return m_pending == 0;
+			} );
+		}
+
+	private:
+		void workerLoop()
+		{
+			while ( true )
+			{
+				std::function< void() > task;
+				{
+					std::unique_lock lock( m_mutex );
+					m_wakeUp.wait( lock, [ this ] ()
+					{
+						return m_isStopping || !m_tasks.empty();
+					} );
+					if ( m_tasks.empty() )
+					{
+						return;
+					}
+					task = std::move( m_tasks.front() );
+					m_tasks.pop_front();
+				}
+
+				task();
+
+				std::scoped_lock lock( m_mutex );
+				if ( --m_pending == 0 )
+				{
+					m_done.notify_all();
+				}
+			}
+		}
+
+		std::mutex m_mutex;
+		std::condition_variable m_wakeUp;
+		std::condition_variable m_done;
+		std::deque< std::function< void() > > m_tasks;
+		size_t m_pending = 0;
+		bool m_isStopping = false;
+		std::vector< std::thread > m_threads;
+	};
+
+	// one task per folder: its files are stat'ed and every subfolder becomes a new task, as a scan of nested options does
+	template< typename Spawn >
+	void scanDirectory( const fs::path& dir, std::atomic< uint64_t >& bytes, const Spawn& spawn )
+	{
+		std::error_code ec;
+		for ( const fs::directory_entry& entry : fs::directory_iterator( dir, ec ) )
+		{
+			if ( entry.is_directory( ec ) )
+			{
+				spawn( entry.path() );
+			}
+			else
+			{
+				bytes += entry.file_size( ec );
+			}
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	const fs::path root = argc > 1 ? fs::path( argv[ 1 ] ) : bench::makeTree( "systemcleaner_bench_tree", 3, 16, 8 );
+	const size_t threadCount = core::TaskManager::instance().getThreadCount();
+	std::printf( "tree %s, %zu threads, median of %zu runs\n", root.string().c_str(), threadCount, RUNS );
+
+	std::atomic< uint64_t > sharedBytes { 0 };
+	SharedQueuePool sharedPool( threadCount );
+	const double sharedTime = bench::measure( RUNS, [ & ] ()
+	{
+		sharedBytes = 0;
+		std::function< void( const fs::path& ) > spawn = [ & ] ( const fs::path& dir )
+		{
+			sharedPool.run( [ &, dir ] ()
+			{
+				scanDirectory( dir, sharedBytes, spawn );
+			} );
+		};
+		spawn( root );
+		sharedPool.wait();
+	} );
+
+	std::atomic< uint64_t > stealingBytes { 0 };
+	const double stealingTime = bench::measure( RUNS, [ & ] ()
+	{
+		stealingBytes = 0;
+		core::TaskGroup group;
+		std::function< void( const fs::path& ) > spawn = [ & ] ( const fs::path& dir )
+		{
+			group.run( [ &, dir ] ()
+			{
+				scanDirectory( dir, stealingBytes, spawn );
+			} );
+		};
+		spawn( root );
+		group.wait();
+	} );
+
+	std::atomic< uint64_t > sharedTasks { 0 };
+	const double sharedSplitTime = bench::measure( RUNS, [ & ] ()
+	{
+		sharedTasks = 0;
+		std::function< void( size_t ) > split = [ & ] ( size_t depth )
+		{
+			sharedPool.run( [ &, depth ] ()
+			{
+				++sharedTasks;
+				if ( depth < SPLIT_DEPTH )
+				{
+					split( depth + 1 );
+					split( depth + 1 );
+				}
+			} );
+		};
+		split( 0 );
+		sharedPool.wait();
+	} );
+
+	std::atomic< uint64_t > stealingTasks { 0 };
+	const double stealingSplitTime = bench::measure( RUNS, [ & ] ()
+	{
+		stealingTasks = 0;
+		core::TaskGroup group;
+		std::function< void( size_t ) > split = [ & ] ( size_t depth )
+		{
+			group.run( [ &, depth ] ()
+			{
+				++stealingTasks;
+				if ( depth < SPLIT_DEPTH )
+				{
+					split( depth + 1 );
+					split( depth + 1 );
+				}
+			} );
+		};
+		split( 0 );
+		group.wait();
+	} );
+
+	std::printf( "                     folder tasks          empty tasks\n" );
+	std::printf( "shared queue pool:   %8.2f ms           %8.2f ms\n", sharedTime, sharedSplitTime );
+	std::printf( "work-stealing pool:  %8.2f ms           %8.2f ms\n", stealingTime, stealingSplitTime );
+	return sharedBytes == stealingBytes && sharedTasks == stealingTasks ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+# Writes a C++ source with the icons and the font as constexpr byte arrays, so startup reads no asset files.
+# Run in script mode: cmake -DICONS_DIR=<dir> -DFONT_FILE=<ttf> -DOUTPUT=<cpp> -P embed_resources.cmake
+
+set(BYTES_PER_LINE 32)
+
+function(embed_file path name result)
+	file(READ "${path}" hex HEX)
+	string(LENGTH "${hex}" hexLength)
+	math(EXPR size "${hexLength} / 2")
+
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+	# cmake regex has no repetition count, the line pattern is spelled out
+	string(REPEAT "0x[0-9a-f][0-9a-f]," ${BYTES_PER_LINE} linePattern)
+	string(REGEX REPLACE "(${linePattern})" "\\1\n\t\t" bytes "${bytes}")
+	set(${result} "\tconstexpr unsigned char ${name}[ ${size} ] =\n\t{\n\t\t${bytes}\n\t};\n\n" PARENT_SCOPE)
+endfunction()
+
+file(GLOB iconFiles "${ICONS_DIR}/*.png")
+list(SORT iconFiles)
+
+set(arrays "")
+set(iconEntries "")
+set(index 0)
+foreach(iconFile ${iconFiles})
+	get_filename_component(iconName "${iconFile}" NAME_WE)
+	embed_file("${iconFile}" "ICON_${index}" array)
+	string(APPEND arrays "${array}")
+	string(APPEND iconEntries "\t\t{ \"${iconName}\", ICON_${index} },\n")
+	math(EXPR index "${index} + 1")
+endforeach()
+
+embed_file("${FONT_FILE}" "FONT" fontArray)
+string(APPEND arrays "${fontArray}")
+
+set(content "// generated by cmake/embed_resources.cmake from source/icons and the ImGui font folder, do not edit\n")
+string(APPEND content "#include \"common/resources.hpp\"\n\nnamespace\n{\n${arrays}")
+string(APPEND content "\tconstexpr common::resources::EmbeddedFile ICONS[] =\n\t{\n${iconEntries}\t};\n}\n\n")
+string(APPEND content "std::span< const common::resources::EmbeddedFile > common::resources::getIcons()\n{\n\treturn ICONS;\n}\n\n")
+string(APPEND content "std::span< const unsigned char > common::resources::getFont()\n{\n\treturn FONT;\n}\n")
+
+file(WRITE "${OUTPUT}" "${content}")
\ No newline at end of file
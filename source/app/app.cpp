@@ -1,14 +1,72 @@
 #include "app.hpp"
 
+#include <functional>
+#include <utility>
+
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 
+#include "app/frame_loop.hpp"
 #include "gui/gui.hpp"
 
 namespace
 {
 	constexpr int HEIGHT = 800;
 	constexpr int WIDTH = 600;
+
+	class WindowPlatform : public FrameLoop::Platform
+	{
+	public:
+		WindowPlatform( core::Window& window, gui::Gui& gui, std::function< void() > draw )
+			: m_window( window ), m_gui( gui ), m_draw( std::move( draw ) )
+		{
+		}
+
+		bool shouldClose() override
+		{
+			return m_window.shouldClose();
+		}
+
+		bool isCollapsed() override
+		{
+			return m_window.getWindowAttrib();
+		}
+
+		double getTime() override
+		{
+			return glfwGetTime();
+		}
+
+		void pollEvents() override
+		{
+			glfwPollEvents();
+		}
+
+		void waitEvents() override
+		{
+			glfwWaitEvents();
+		}
+
+		void waitEvents( double timeout ) override
+		{
+			glfwWaitEventsTimeout( timeout );
+		}
+
+		void drawFrame() override
+		{
+			m_draw();
+		}
+
+		bool isBusy() override
+		{
+			return m_gui.isBusy();
+		}
+
+	private:
+		core::Window& m_window;
+		gui::Gui& m_gui;
+		std::function< void() > m_draw;
+	};
 }
 
 App::App() : m_window( HEIGHT, WIDTH )
@@ -25,31 +83,49 @@ void App::run()
 {
 	gui::Gui gui( m_window );
 
-	while ( !m_window.shouldClose() )
+	float firstFrameMs = 0.f;
+	bool isStartupMeasured = false;
+	WindowPlatform platform( m_window, gui, [ & ] ()
 	{
-		glfwPollEvents();
+		drawFrame( gui );
 
-		// skip if window collapsed
-		if ( m_window.getWindowAttrib() )
+		// time to first frame and time until every startup section is on screen
+		if ( !isStartupMeasured )
 		{
-			glfwWaitEvents();
-			continue;
+			firstFrameMs = firstFrameMs > 0.f ? firstFrameMs : getElapsedMs();
+			if ( gui.isInteractive() )
+			{
+				gui.setStartupTimes( firstFrameMs, getElapsedMs() );
+				isStartupMeasured = true;
+			}
 		}
+	} );
 
-		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
+	FrameLoop loop( platform );
+	loop.run();
+}
 
-		gui.render();
+void App::drawFrame( gui::Gui& gui )
+{
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
 
-		ImGui::Render();
-		glViewport( 0, 0, 800, 600 );
-		glClearColor( 0.2f, 0.3f, 0.4f, 1.0f );
-		glClear( GL_COLOR_BUFFER_BIT );
-		ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData() );
+	gui.render();
 
-		m_window.swapBuffers();
-	}
+	ImGui::Render();
+	glViewport( 0, 0, 800, 600 );
+	glClearColor( 0.2f, 0.3f, 0.4f, 1.0f );
+	glClear( GL_COLOR_BUFFER_BIT );
+	ImGui_ImplOpenGL3_RenderDrawData( ImGui::GetDrawData() );
+
+	m_window.swapBuffers();
+}
+
+float App::getElapsedMs() const
+{
+	const std::chrono::duration< float, std::milli > elapsed = std::chrono::steady_clock::now() - m_startTime;
+	return elapsed.count();
 }
 
 void App::initGui()
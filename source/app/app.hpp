@@ -1,9 +1,15 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 
 #include "core/window.hpp"
 
+namespace gui
+{
+	class Gui;
+}
+
 class App
 {
 public:
@@ -13,8 +19,12 @@ public:
 	void run();
 
 private:
+	void drawFrame( gui::Gui& gui );
+	[[nodiscard]] float getElapsedMs() const;
 	void initGui();
 	void finiGui();
 
+	// declared first, so it is taken before the window is created
+	std::chrono::steady_clock::time_point m_startTime = std::chrono::steady_clock::now();
 	core::Window m_window;
 };
\ No newline at end of file
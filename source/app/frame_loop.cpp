@@ -0,0 +1,59 @@
+#include "frame_loop.hpp"
+
+namespace
+{
+	// imgui settles hover and popup state a frame or two after the input that changed it
+	constexpr int FRAMES_AFTER_INPUT = 3;
+	// progress of a run is redrawn at this rate, not on every vsync
+	constexpr double RUN_FRAME_INTERVAL = 1.0 / 30.0;
+	// nothing should change without an event, the timeout is only a safety net
+	constexpr double IDLE_TIMEOUT = 1.0;
+}
+
+FrameLoop::FrameLoop( Platform& platform ) : m_platform( platform )
+{
+}
+
+void FrameLoop::run()
+{
+	int framesToDraw = FRAMES_AFTER_INPUT;
+	while ( !m_platform.shouldClose() )
+	{
+		// skip if window collapsed
+		if ( m_platform.isCollapsed() )
+		{
+			m_platform.waitEvents();
+			framesToDraw = FRAMES_AFTER_INPUT;
+			continue;
+		}
+
+		const double frameStart = m_platform.getTime();
+		m_platform.drawFrame();
+
+		if ( framesToDraw > 0 )
+		{
+			--framesToDraw;
+			m_platform.pollEvents();
+			continue;
+		}
+
+		if ( m_platform.isBusy() )
+		{
+			// input is still handled while waiting, it is just drawn with the next frame
+			const double nextFrame = frameStart + RUN_FRAME_INTERVAL;
+			for ( double now = m_platform.getTime(); now < nextFrame && !m_platform.shouldClose(); now = m_platform.getTime() )
+			{
+				m_platform.waitEvents( nextFrame - now );
+			}
+			continue;
+		}
+
+		// woken by input or by the cleaner through glfwPostEmptyEvent
+		const double waitStart = m_platform.getTime();
+		m_platform.waitEvents( IDLE_TIMEOUT );
+		if ( m_platform.getTime() - waitStart < IDLE_TIMEOUT )
+		{
+			framesToDraw = FRAMES_AFTER_INPUT;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+// paces the main loop: frames are drawn after input, at a fixed rate during a run and otherwise only when woken.
+// it knows nothing of glfw or imgui, so it can be driven without a window
+class FrameLoop
+{
+public:
+	// what the loop runs on, the window in the app
+	class Platform
+	{
+	public:
+		virtual ~Platform() = default;
+
+		[[nodiscard]] virtual bool shouldClose() = 0;
+		// a collapsed window draws nothing until the next event
+		[[nodiscard]] virtual bool isCollapsed() = 0;
+		// in seconds, like glfwGetTime
+		[[nodiscard]] virtual double getTime() = 0;
+		virtual void pollEvents() = 0;
+		virtual void waitEvents() = 0;
+		virtual void waitEvents( double timeout ) = 0;
+		virtual void drawFrame() = 0;
+		// a run is going, its progress is redrawn at a fixed rate
+		[[nodiscard]] virtual bool isBusy() = 0;
+	};
+
+	explicit FrameLoop( Platform& platform );
+
+	// returns once the platform should close
+	void run();
+
+private:
+	Platform& m_platform;
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <filesystem>
 #include <ranges>
 #include <string>
@@ -25,6 +26,7 @@ namespace common
 		NONE,
 		ANALYSIS,
 		CLEANING,
+		DUPLICATES
 	};
 
 	struct CleanOption
@@ -55,6 +57,27 @@ namespace common
 		}
 	};
 
+	struct PathImportEntry
+	{
+		std::string path;
+		PathAdditionResult result;
+	};
+
+	struct ImportResult
+	{
+		// saved paths restored at startup, failures are not reported to the user
+		bool isRestore = false;
+		std::vector< PathImportEntry > entries;
+
+		size_t countAdded() const noexcept
+		{
+			return std::ranges::count_if( entries, [] ( const PathImportEntry& entry )
+			{
+				return entry.result.isSuccess();
+			} );
+		}
+	};
+
 	enum class ItemType
 	{
 		NONE,
@@ -84,9 +107,10 @@ namespace common
 		}
 
 		std::string name;
-		uint64_t textureID = 0;
 		ItemType itemType;
 		std::vector< CleanOption > cleanOptions;
+		// loaded from the targets file, replaced as a whole when it is reloaded
+		bool isConfigured = false;
 	};
 
 	struct CleanResult
@@ -95,25 +119,69 @@ namespace common
 		std::string categoryName;
 		uint64_t cleanedFiles = 0;
 		uint64_t cleanedSize = 0;
-		uint64_t textureID = 0;
+		// files behind the result, filled for duplicate groups
+		std::vector< std::string > paths;
+	};
+
+	// decisions of the adaptive worker limit during a run, summed over devices
+	struct ConcurrencyStats
+	{
+		size_t peakWorkers = 0;
+		size_t finalWorkers = 0;
+		uint32_t increases = 0;
+		uint32_t decreases = 0;
+		float peakOpsPerSecond = 0.f;
+	};
+
+	// filesystem errors a run stepped over, by class
+	struct ErrorStats
+	{
+		void add( const ErrorStats& stats )
+		{
+			denied += stats.denied;
+			busy += stats.busy;
+			missing += stats.missing;
+			other += stats.other;
+		}
+
+		uint64_t denied = 0;
+		// held by another process, a pinned file found by the open file index is not an error
+		uint64_t busy = 0;
+		// gone between listing and removal
+		uint64_t missing = 0;
+		uint64_t other = 0;
 	};
 
 	struct Summary
 	{
 		SummaryType type = SummaryType::NONE;
+		// stopped by cancel or a timeout before all targets were done
+		bool isCancelled = false;
 
 		float totalTime = 0.f;
 		uint64_t totalFiles = 0;
 		uint64_t totalSize = 0;
+		uint64_t removedDirs = 0;
+		// space held by files other processes keep open, not included in totalSize
+		uint64_t pinnedFiles = 0;
+		uint64_t pinnedSize = 0;
+		ConcurrencyStats concurrency;
+		ErrorStats errors;
 
 		std::vector< CleanResult > results;
 
 		void reset()
 		{
 			type = SummaryType::NONE;
+			isCancelled = false;
 			totalTime = 0.f;
 			totalFiles = 0;
 			totalSize = 0;
+			removedDirs = 0;
+			pinnedFiles = 0;
+			pinnedSize = 0;
+			concurrency = {};
+			errors = {};
 			results.clear();
 		}
 	};
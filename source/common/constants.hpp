@@ -9,14 +9,29 @@ namespace common
 	constexpr std::string_view MOZILLA_FIREFOX = "Mozilla Firefox";
 	constexpr std::string_view OPERA = "Opera";
 	constexpr std::string_view YANDEX_BROWSER = "YandexBrowser";
+	constexpr std::string_view CHROMIUM = "Chromium";
 
 	constexpr std::string_view GOOGLE_CHROME_PATH = "Google\\Chrome";
 	constexpr std::string_view MICROSOFT_EDGE_PATH = "Microsoft\\Edge";
 	constexpr std::string_view MOZILLA_FIREFOX_PATH = "Mozilla\\Firefox";
 	constexpr std::string_view OPERA_PATH = "Opera Software\\Opera Stable";	
 	constexpr std::string_view YANDEX_BROWSER_PATH = "Yandex\\YandexBrowser";
+	constexpr std::string_view CHROMIUM_PATH = "Chromium";
 
-	constexpr std::string_view USER_DATA_DEFAULT = "User Data\\Default";
+	constexpr std::string_view USER_DATA = "User Data";
+
+	// relative to the XDG config and cache folders
+	constexpr std::string_view GOOGLE_CHROME_XDG_PATH = "google-chrome";
+	constexpr std::string_view MICROSOFT_EDGE_XDG_PATH = "microsoft-edge";
+	constexpr std::string_view OPERA_XDG_PATH = "opera";
+	constexpr std::string_view YANDEX_BROWSER_XDG_PATH = "yandex-browser";
+	constexpr std::string_view CHROMIUM_XDG_PATH = "chromium";
+	constexpr std::string_view MOZILLA_FIREFOX_XDG_PATH = "mozilla/firefox";
+
+	// relative to the home folder
+	constexpr std::string_view MOZILLA_FIREFOX_HOME_PATH = ".mozilla/firefox";
+	constexpr std::string_view MOZILLA_FIREFOX_SNAP_PATH = "snap/firefox/common/.mozilla/firefox";
+	constexpr std::string_view MOZILLA_FIREFOX_SNAP_CACHE_PATH = "snap/firefox/common/.cache/mozilla/firefox";
 
 	constexpr char TEMP[] = "Temp";
 	constexpr char SYSTEM[] = "System";
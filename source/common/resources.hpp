@@ -0,0 +1,17 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+namespace common::resources
+{
+	struct EmbeddedFile
+	{
+		std::string_view name;
+		std::span< const unsigned char > data;
+	};
+
+	// compiled into the binary by cmake/embed_resources.cmake, the icons are keyed by file name without extension
+	[[nodiscard]] std::span< const EmbeddedFile > getIcons();
+	[[nodiscard]] std::span< const unsigned char > getFont();
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <imgui.h>
 
 #include <string>
+#include <string_view>
 
 namespace ImGui
 {
@@ -19,9 +20,9 @@ namespace ImGui
 
 	struct IDGuard
 	{
-		IDGuard( std::string id )
+		IDGuard( std::string_view id )
 		{
-			ImGui::PushID( id.c_str() );
+			ImGui::PushID( id.data(), id.data() + id.size() );
 		}
 
 		IDGuard( uint64_t id )
@@ -15,4 +15,13 @@ namespace common
 	using OptionalString = std::optional< std::string >;
 
 	using CleaningItems = std::vector< common::CleaningItem >;
+
+	struct DiscoveredItems
+	{
+		CleaningItems items;
+		// the targets file was loaded again, configured items taken before are dropped
+		bool isTargetsReload = false;
+		// lines of the targets file that were skipped
+		std::vector< std::string > targetErrors;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <semaphore>
+#include <type_traits>
+#include <utility>
+
+namespace core
+{
+	template< typename T >
+	class Task;
+
+	namespace detail
+	{
+		template< typename T >
+		struct TaskResult
+		{
+			std::optional< T > value;
+
+			void return_value( T result )
+			{
+				value = std::move( result );
+			}
+
+			T take()
+			{
+				return std::move( *value );
+			}
+		};
+
+		template<>
+		struct TaskResult< void >
+		{
+			void return_void() noexcept {}
+			void take() noexcept {}
+		};
+	}
+
+	// lazy coroutine, it starts when awaited and resumes its awaiter on the thread it finishes on.
+	// suspension points inside it, such as a TaskHandle, move the work onto the pool
+	template< typename T = void >
+	class [[nodiscard]] Task
+	{
+	public:
+		struct promise_type : detail::TaskResult< T >
+		{
+			std::coroutine_handle<> continuation = std::noop_coroutine();
+			std::exception_ptr exception;
+
+			Task get_return_object() noexcept
+			{
+				return Task( std::coroutine_handle< promise_type >::from_promise( *this ) );
+			}
+
+			std::suspend_always initial_suspend() noexcept
+			{
+				return {};
+			}
+
+			auto final_suspend() noexcept
+			{
+				struct FinalAwaiter
+				{
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+
+					std::coroutine_handle<> await_suspend( std::coroutine_handle< promise_type > handle ) const noexcept
+					{
+						return handle.promise().continuation;
+					}
+
+					void await_resume() const noexcept {}
+				};
+				return FinalAwaiter {};
+			}
+
+			void unhandled_exception() noexcept
+			{
+				exception = std::current_exception();
+			}
+		};
+
+		Task( Task&& other ) noexcept : m_handle( std::exchange( other.m_handle, {} ) ) {}
+		Task& operator = ( Task&& other ) noexcept
+		{
+			if ( this != &other )
+			{
+				destroy();
+				m_handle = std::exchange( other.m_handle, {} );
+			}
+			return *this;
+		}
+		Task( const Task& ) = delete;
+		Task& operator = ( const Task& ) = delete;
+
+		~Task()
+		{
+			destroy();
+		}
+
+		auto operator co_await() && noexcept
+		{
+			struct Awaiter
+			{
+				std::coroutine_handle< promise_type > handle;
+
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				std::coroutine_handle<> await_suspend( std::coroutine_handle<> awaiting ) const noexcept
+				{
+					handle.promise().continuation = awaiting;
+					return handle;
+				}
+
+				T await_resume() const
+				{
+					if ( handle.promise().exception )
+					{
+						std::rethrow_exception( handle.promise().exception );
+					}
+					return handle.promise().take();
+				}
+			};
+			return Awaiter { m_handle };
+		}
+
+	private:
+		explicit Task( std::coroutine_handle< promise_type > handle ) noexcept : m_handle( handle ) {}
+
+		void destroy()
+		{
+			if ( m_handle )
+			{
+				m_handle.destroy();
+			}
+		}
+
+		std::coroutine_handle< promise_type > m_handle;
+	};
+
+	namespace detail
+	{
+		// driver started by syncWait that releases the semaphore once the awaited task is done
+		struct SyncWaitTask
+		{
+			struct promise_type
+			{
+				std::binary_semaphore* done = nullptr;
+
+				SyncWaitTask get_return_object() noexcept
+				{
+					return SyncWaitTask { std::coroutine_handle< promise_type >::from_promise( *this ) };
+				}
+
+				std::suspend_always initial_suspend() noexcept
+				{
+					return {};
+				}
+
+				auto final_suspend() noexcept
+				{
+					struct ReleaseAwaiter
+					{
+						bool await_ready() const noexcept
+						{
+							return false;
+						}
+
+						void await_suspend( std::coroutine_handle< promise_type > handle ) const noexcept
+						{
+							handle.promise().done->release();
+						}
+
+						void await_resume() const noexcept {}
+					};
+					return ReleaseAwaiter {};
+				}
+
+				void return_void() noexcept {}
+				void unhandled_exception() noexcept {}
+			};
+
+			std::coroutine_handle< promise_type > handle;
+		};
+
+		template< typename T >
+		SyncWaitTask runSyncWait( Task< T >& task, std::optional< std::conditional_t< std::is_void_v< T >, bool, T > >& result, std::exception_ptr& exception )
+		{
+			try
+			{
+				if constexpr ( std::is_void_v< T > )
+				{
+					co_await std::move( task );
+					result = true;
+				}
+				else
+				{
+					result = co_await std::move( task );
+				}
+			}
+			catch ( ... )
+			{
+				exception = std::current_exception();
+			}
+		}
+	}
+
+	// blocks the calling thread until the task is done. meant for threads outside the pool, such as main or a CLI
+	template< typename T >
+	T syncWait( Task< T > task )
+	{
+		std::binary_semaphore done( 0 );
+		std::optional< std::conditional_t< std::is_void_v< T >, bool, T > > result;
+		std::exception_ptr exception;
+
+		detail::SyncWaitTask driver = detail::runSyncWait( task, result, exception );
+		driver.handle.promise().done = &done;
+		driver.handle.resume();
+		done.acquire();
+		driver.handle.destroy();
+
+		if ( exception )
+		{
+			std::rethrow_exception( exception );
+		}
+
+		if constexpr ( !std::is_void_v< T > )
+		{
+			return std::move( *result );
+		}
+	}
+}
\ No newline at end of file
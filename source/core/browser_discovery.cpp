@@ -0,0 +1,230 @@
+#include "browser_discovery.hpp"
+
+#include <algorithm>
+
+#include "common/constants.hpp"
+#include "core/task_manager.hpp"
+#include "utils/filesystem.hpp"
+
+namespace
+{
+	constexpr std::string_view CACHE = "Cache";
+	constexpr std::string_view COOKIES = "Cookies";
+	constexpr std::string_view HISTORY = "History";
+
+	constexpr std::string_view CHROMIUM_DEFAULT_PROFILE = "Default";
+	constexpr std::string_view CHROMIUM_PROFILE_MARKER = "Preferences";
+	constexpr std::string_view FIREFOX_PROFILE_MARKER = "prefs.js";
+
+	enum class BrowserEngine
+	{
+		CHROMIUM,
+		FIREFOX
+	};
+
+	struct BrowserLayout
+	{
+		std::string_view name;
+		BrowserEngine engine;
+		fs::path dataRoot;
+		// profiles keep the same folder names under the cache root
+		fs::path cacheRoot;
+		// Opera keeps its only profile in the root itself
+		bool isSingleProfile = false;
+		// tells apart the options of layouts merged into one browser, e.g. the snap package. the listings below leave it out
+		std::string_view variant {};
+	};
+
+	struct Profile
+	{
+		std::string label;
+		fs::path dataDir;
+		fs::path cacheDir;
+	};
+
+	std::vector< BrowserLayout > getLayouts()
+	{
+		const utils::FileSystem& fileSystem = utils::FileSystem::instance();
+		const fs::path local = fileSystem.getLocalAppDataDir();
+		const fs::path roaming = fileSystem.getRoamingAppDataDir();
+		const fs::path cache = fileSystem.getCacheDir();
+		const fs::path home = fileSystem.getHomeDir();
+
+#ifdef _WIN32
+		auto chromium = [ & ] ( std::string_view name, std::string_view path ) -> BrowserLayout
+		{
+			const fs::path userData = local / path / common::USER_DATA;
+			return { name, BrowserEngine::CHROMIUM, userData, userData };
+		};
+
+		const fs::path firefoxProfiles = fs::path( common::MOZILLA_FIREFOX_PATH ) / "Profiles";
+		return
+		{
+			chromium( common::GOOGLE_CHROME, common::GOOGLE_CHROME_PATH ),
+			{ common::MOZILLA_FIREFOX, BrowserEngine::FIREFOX, roaming / firefoxProfiles, local / firefoxProfiles },
+			chromium( common::YANDEX_BROWSER, common::YANDEX_BROWSER_PATH ),
+			chromium( common::MICROSOFT_EDGE, common::MICROSOFT_EDGE_PATH ),
+			{ common::OPERA, BrowserEngine::CHROMIUM, roaming / common::OPERA_PATH, local / common::OPERA_PATH, true },
+			chromium( common::CHROMIUM, common::CHROMIUM_PATH )
+		};
+#else
+		auto chromium = [ & ] ( std::string_view name, std::string_view path, bool isSingleProfile = false ) -> BrowserLayout
+		{
+			return { name, BrowserEngine::CHROMIUM, roaming / path, cache / path, isSingleProfile };
+		};
+
+		return
+		{
+			chromium( common::GOOGLE_CHROME, common::GOOGLE_CHROME_XDG_PATH ),
+			{ common::MOZILLA_FIREFOX, BrowserEngine::FIREFOX, home / common::MOZILLA_FIREFOX_HOME_PATH, cache / common::MOZILLA_FIREFOX_XDG_PATH },
+			{ common::MOZILLA_FIREFOX, BrowserEngine::FIREFOX, home / common::MOZILLA_FIREFOX_SNAP_PATH, home / common::MOZILLA_FIREFOX_SNAP_CACHE_PATH, false, "snap" },
+			chromium( common::YANDEX_BROWSER, common::YANDEX_BROWSER_XDG_PATH ),
+			chromium( common::MICROSOFT_EDGE, common::MICROSOFT_EDGE_XDG_PATH ),
+			chromium( common::OPERA, common::OPERA_XDG_PATH, true ),
+			chromium( common::CHROMIUM, common::CHROMIUM_XDG_PATH )
+		};
+#endif
+	}
+
+	std::vector< Profile > findProfiles( const BrowserLayout& layout )
+	{
+		std::vector< Profile > profiles;
+		std::error_code ec;
+		if ( layout.isSingleProfile )
+		{
+			if ( fs::is_directory( layout.dataRoot, ec ) )
+			{
+				profiles.push_back( { "", layout.dataRoot, layout.cacheRoot } );
+			}
+			return profiles;
+		}
+
+		const std::string_view marker = layout.engine == BrowserEngine::CHROMIUM ? CHROMIUM_PROFILE_MARKER : FIREFOX_PROFILE_MARKER;
+		try
+		{
+			for ( const fs::directory_entry& entry : fs::directory_iterator( layout.dataRoot, fs::directory_options::skip_permission_denied, ec ) )
+			{
+				if ( !entry.is_directory() || !fs::exists( entry.path() / marker ) )
+				{
+					continue;
+				}
+
+				const fs::path folderName = entry.path().filename();
+				std::string label = utils::pathToString( folderName );
+				if ( layout.engine == BrowserEngine::FIREFOX )
+				{
+					// "xxxxxxxx.default-release" is shown as "default-release"
+					const size_t dot = label.find( '.' );
+					label = dot == std::string::npos ? label : label.substr( dot + 1 );
+				}
+				else if ( label == CHROMIUM_DEFAULT_PROFILE )
+				{
+					label.clear();
+				}
+
+				profiles.push_back( { std::move( label ), entry.path(), layout.cacheRoot / folderName } );
+			}
+		}
+		catch ( const fs::filesystem_error& ) {}
+
+		// the default profile goes first
+		std::sort( profiles.begin(), profiles.end(), [] ( const Profile& p1, const Profile& p2 )
+		{
+			return std::make_pair( !p1.label.empty(), p1.label ) < std::make_pair( !p2.label.empty(), p2.label );
+		} );
+
+		// a single Firefox profile needs no label
+		if ( layout.engine == BrowserEngine::FIREFOX && profiles.size() == 1 )
+		{
+			profiles.front().label.clear();
+		}
+
+		for ( Profile& profile : profiles )
+		{
+			if ( !layout.variant.empty() )
+			{
+				profile.label = profile.label.empty() ? std::string( layout.variant ) : std::string( layout.variant ) + ", " + profile.label;
+			}
+		}
+
+		return profiles;
+	}
+
+	std::vector< core::BrowserOption > collectOptions( const BrowserLayout& layout )
+	{
+		std::vector< core::BrowserOption > options;
+		for ( const Profile& profile : findProfiles( layout ) )
+		{
+			std::vector< std::pair< std::string_view, fs::path > > candidates;
+			if ( layout.engine == BrowserEngine::CHROMIUM )
+			{
+				candidates =
+				{
+					{ CACHE, profile.cacheDir / "Cache" },
+					{ COOKIES, profile.dataDir / "Network" / "Cookies" },
+					{ COOKIES, profile.dataDir / "Cookies" },
+					{ HISTORY, profile.dataDir / "History" }
+				};
+			}
+			else
+			{
+				candidates =
+				{
+					{ CACHE, profile.cacheDir / "cache2" / "entries" },
+					{ COOKIES, profile.dataDir / "cookies.sqlite" },
+					{ HISTORY, profile.dataDir / "places.sqlite" }
+				};
+			}
+
+			const std::string suffix = profile.label.empty() ? "" : " (" + profile.label + ")";
+			std::string_view lastAdded;
+			for ( const auto& [ displayName, fullPath ] : candidates )
+			{
+				// newer Chromium moved cookies into Network, only one location is used
+				std::error_code ec;
+				if ( displayName != lastAdded && fs::exists( fullPath, ec ) )
+				{
+					options.push_back( { std::string( displayName ) + suffix, fullPath } );
+					lastAdded = displayName;
+				}
+			}
+		}
+		return options;
+	}
+}
+
+std::vector< core::DiscoveredBrowser > core::discoverBrowsers()
+{
+	const std::vector< BrowserLayout > layouts = getLayouts();
+
+	std::vector< std::vector< BrowserOption > > layoutOptions( layouts.size() );
+	TaskManager::instance().parallelFor( layouts.size(), [ & ] ( size_t i )
+	{
+		layoutOptions[ i ] = collectOptions( layouts[ i ] );
+	} );
+
+	// layouts of the same browser are merged into one item, the layout order is kept
+	std::vector< DiscoveredBrowser > browsers;
+	for ( size_t i = 0; i < layouts.size(); ++i )
+	{
+		if ( layoutOptions[ i ].empty() )
+		{
+			continue;
+		}
+
+		auto it = std::find_if( browsers.begin(), browsers.end(), [ & ] ( const DiscoveredBrowser& browser )
+		{
+			return browser.name == layouts[ i ].name;
+		} );
+
+		if ( it == browsers.end() )
+		{
+			browsers.push_back( { std::string( layouts[ i ].name ), {} } );
+			it = std::prev( browsers.end() );
+		}
+
+		it->options.insert( it->options.end(), std::make_move_iterator( layoutOptions[ i ].begin() ), std::make_move_iterator( layoutOptions[ i ].end() ) );
+	}
+
+	return browsers;
+}
\ No newline at end of file
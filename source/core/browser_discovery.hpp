@@ -0,0 +1,25 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	struct BrowserOption
+	{
+		std::string displayName;
+		fs::path path;
+	};
+
+	struct DiscoveredBrowser
+	{
+		std::string name;
+		std::vector< BrowserOption > options;
+	};
+
+	// probes every known browser layout in parallel and lists the existing cache, cookies and history of all profiles
+	[[nodiscard]] std::vector< DiscoveredBrowser > discoverBrowsers();
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "cache_index.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	// Firefox cache2/index: big-endian header, fixed size records, trailing hash.
+	// the record layout below is the one of version 0xA, older versions are walked
+	constexpr uint32_t FIREFOX_VERSION = 0xA;
+	constexpr size_t FIREFOX_HEADER_SIZE = 16;
+	constexpr size_t FIREFOX_RECORD_SIZE = 41;
+	constexpr size_t FIREFOX_FLAGS_OFFSET = 37;
+	constexpr size_t FIREFOX_HASH_SIZE = 4;
+	constexpr uint32_t FIREFOX_FILE_SIZE_MASK = 0x00FFFFFF;
+
+	// Chromium block file cache: Cache_Data/index with a little-endian IndexHeader
+	constexpr uint32_t BLOCKFILE_MAGIC = 0xC103CAC3;
+	constexpr uint32_t BLOCKFILE_VERSION_3 = 0x30000;
+	constexpr size_t BLOCKFILE_HEADER_SIZE = 56;
+
+	// Chromium simple cache: Cache_Data/index-dir/the-real-index, a pickle with IndexMetadata up front
+	constexpr uint64_t SIMPLE_MAGIC = 0x656e74657220796full;
+	constexpr uint32_t SIMPLE_MIN_VERSION = 7;
+	constexpr uint32_t SIMPLE_MAX_VERSION = 9;
+	constexpr size_t SIMPLE_METADATA_OFFSET = 8;
+	constexpr size_t SIMPLE_METADATA_SIZE = 28;
+
+	constexpr uint64_t KILOBYTE = 1024;
+
+	std::optional< std::vector< uint8_t > > readFile( const fs::path& path, size_t maxSize = SIZE_MAX )
+	{
+		std::ifstream input( path, std::ios::binary | std::ios::ate );
+		if ( !input )
+		{
+			return std::nullopt;
+		}
+
+		const std::streamoff size = input.tellg();
+		if ( size <= 0 )
+		{
+			return std::nullopt;
+		}
+
+		std::vector< uint8_t > buffer( std::min< size_t >( static_cast< size_t >( size ), maxSize ) );
+		input.seekg( 0 );
+		if ( !input.read( reinterpret_cast< char* >( buffer.data() ), buffer.size() ) )
+		{
+			return std::nullopt;
+		}
+		return buffer;
+	}
+
+	uint32_t readBigEndian32( const uint8_t* data )
+	{
+		return ( uint32_t( data[ 0 ] ) << 24 ) | ( uint32_t( data[ 1 ] ) << 16 ) | ( uint32_t( data[ 2 ] ) << 8 ) | uint32_t( data[ 3 ] );
+	}
+
+	template< typename T >
+	T readLittleEndian( const uint8_t* data )
+	{
+		T value = 0;
+		for ( size_t i = 0; i < sizeof( T ); ++i )
+		{
+			value |= static_cast< T >( data[ i ] ) << ( 8 * i );
+		}
+		return value;
+	}
+
+	// an index written before the last change of its folder no longer describes it
+	bool isOlderThan( const fs::path& indexPath, const fs::path& dirPath )
+	{
+		std::error_code ec;
+		const fs::file_time_type indexTime = fs::last_write_time( indexPath, ec );
+		if ( ec )
+		{
+			return true;
+		}
+
+		const fs::file_time_type dirTime = fs::last_write_time( dirPath, ec );
+		return ec || indexTime < dirTime;
+	}
+
+	std::optional< core::DirInfo > readFirefoxIndex( const fs::path& entriesPath )
+	{
+		const fs::path indexPath = entriesPath.parent_path() / "index";
+		if ( isOlderThan( indexPath, entriesPath ) )
+		{
+			return std::nullopt;
+		}
+
+		const std::optional< std::vector< uint8_t > > buffer = readFile( indexPath );
+		if ( !buffer || buffer->size() < FIREFOX_HEADER_SIZE + FIREFOX_HASH_SIZE ||
+			( buffer->size() - FIREFOX_HEADER_SIZE - FIREFOX_HASH_SIZE ) % FIREFOX_RECORD_SIZE != 0 )
+		{
+			return std::nullopt;
+		}
+
+		const uint8_t* data = buffer->data();
+		const uint32_t version = readBigEndian32( data );
+		const uint32_t isDirty = readBigEndian32( data + 8 );
+		if ( version != FIREFOX_VERSION || isDirty != 0 )
+		{
+			return std::nullopt;
+		}
+
+		core::DirInfo info;
+		const size_t end = buffer->size() - FIREFOX_HASH_SIZE;
+		for ( size_t offset = FIREFOX_HEADER_SIZE; offset < end; offset += FIREFOX_RECORD_SIZE )
+		{
+			// sizes are kept in kilobytes, so the result is approximate
+			const uint32_t flags = readBigEndian32( data + offset + FIREFOX_FLAGS_OFFSET );
+			info.dirSize += ( flags & FIREFOX_FILE_SIZE_MASK ) * KILOBYTE;
+			++info.countFile;
+		}
+		return info;
+	}
+
+	std::optional< core::DirInfo > readBlockFileIndex( const fs::path& indexPath )
+	{
+		const std::optional< std::vector< uint8_t > > buffer = readFile( indexPath, BLOCKFILE_HEADER_SIZE );
+		if ( !buffer || buffer->size() < BLOCKFILE_HEADER_SIZE )
+		{
+			return std::nullopt;
+		}
+
+		// the header is memory mapped by Chromium and kept current, only a crash makes it unreliable
+		const uint8_t* data = buffer->data();
+		const uint32_t magic = readLittleEndian< uint32_t >( data );
+		const uint32_t version = readLittleEndian< uint32_t >( data + 4 );
+		const int32_t numEntries = readLittleEndian< int32_t >( data + 8 );
+		const int32_t crash = readLittleEndian< int32_t >( data + 32 );
+		if ( magic != BLOCKFILE_MAGIC || crash != 0 || numEntries < 0 )
+		{
+			return std::nullopt;
+		}
+
+		const int64_t numBytes = version >= BLOCKFILE_VERSION_3 ?
+			readLittleEndian< int64_t >( data + 48 ) : readLittleEndian< int32_t >( data + 12 );
+		if ( numBytes < 0 )
+		{
+			return std::nullopt;
+		}
+
+		return core::DirInfo { .dirSize = static_cast< uint64_t >( numBytes ), .countFile = static_cast< uint64_t >( numEntries ), .errors = {} };
+	}
+
+	std::optional< core::DirInfo > readSimpleIndex( const fs::path& cacheDataPath, const fs::path& indexPath )
+	{
+		if ( isOlderThan( indexPath, cacheDataPath ) )
+		{
+			return std::nullopt;
+		}
+
+		const std::optional< std::vector< uint8_t > > buffer = readFile( indexPath, SIMPLE_METADATA_OFFSET + SIMPLE_METADATA_SIZE );
+		if ( !buffer || buffer->size() < SIMPLE_METADATA_OFFSET + SIMPLE_METADATA_SIZE )
+		{
+			return std::nullopt;
+		}
+
+		// pickle fields are 4-byte aligned, so the 64-bit fields follow each other without padding
+		const uint8_t* metadata = buffer->data() + SIMPLE_METADATA_OFFSET;
+		const uint64_t magic = readLittleEndian< uint64_t >( metadata );
+		const uint32_t version = readLittleEndian< uint32_t >( metadata + 8 );
+		if ( magic != SIMPLE_MAGIC || version < SIMPLE_MIN_VERSION || version > SIMPLE_MAX_VERSION )
+		{
+			return std::nullopt;
+		}
+
+		const uint64_t entryCount = readLittleEndian< uint64_t >( metadata + 12 );
+		const uint64_t cacheSize = readLittleEndian< uint64_t >( metadata + 20 );
+		return core::DirInfo { .dirSize = cacheSize, .countFile = entryCount, .errors = {} };
+	}
+}
+
+std::optional< core::DirInfo > core::readCacheIndex( const fs::path& cachePath )
+{
+	std::error_code ec;
+	if ( cachePath.filename() == "entries" && cachePath.parent_path().filename() == "cache2" )
+	{
+		return readFirefoxIndex( cachePath );
+	}
+
+	const fs::path cacheData = fs::is_directory( cachePath / "Cache_Data", ec ) ? cachePath / "Cache_Data" : cachePath;
+
+	const fs::path simpleIndex = cacheData / "index-dir" / "the-real-index";
+	if ( fs::exists( simpleIndex, ec ) )
+	{
+		return readSimpleIndex( cacheData, simpleIndex );
+	}
+
+	const fs::path blockFileIndex = cacheData / "index";
+	if ( fs::exists( blockFileIndex, ec ) )
+	{
+		return readBlockFileIndex( blockFileIndex );
+	}
+
+	return std::nullopt;
+}
\ No newline at end of file
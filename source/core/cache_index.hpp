@@ -0,0 +1,15 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+#include "core/dir_info.hpp"
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// sizes a browser cache from the index the browser keeps next to it.
+	// nullopt when the index is missing, unknown or older than the cache, then the folder has to be walked
+	[[nodiscard]] std::optional< DirInfo > readCacheIndex( const fs::path& cachePath );
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "concurrency_controller.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr size_t INITIAL_LIMIT = 2;
+	constexpr std::chrono::milliseconds SAMPLE_INTERVAL( 100 );
+	// latency above the best one by this factor means the device is queueing requests
+	constexpr double LATENCY_TOLERANCE = 1.5;
+	// the best latency slowly ages, so a change of load is noticed
+	constexpr double MIN_LATENCY_DECAY = 1.02;
+}
+
+core::ConcurrencyController::ConcurrencyController( size_t maxLimit ) :
+	m_maxLimit( std::max< size_t >( maxLimit, 1 ) ),
+	m_limit( std::min( INITIAL_LIMIT, m_maxLimit ) ),
+	m_sampleStart( clock::now().time_since_epoch().count() )
+{
+	m_stats.peakWorkers = m_limit;
+}
+
+bool core::ConcurrencyController::tryAcquire()
+{
+	size_t active = m_active;
+	while ( active < m_limit )
+	{
+		if ( m_active.compare_exchange_weak( active, active + 1 ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void core::ConcurrencyController::release()
+{
+	--m_active;
+}
+
+bool core::ConcurrencyController::releaseIfOverLimit()
+{
+	size_t active = m_active;
+	while ( active > m_limit )
+	{
+		if ( m_active.compare_exchange_weak( active, active - 1 ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void core::ConcurrencyController::recordOperations( size_t count )
+{
+	m_operations += count;
+
+	// only the worker that crosses the interval evaluates, the others go on without waiting
+	const clock::time_point now = clock::now();
+	if ( now.time_since_epoch().count() - m_sampleStart < clock::duration( SAMPLE_INTERVAL ).count() )
+	{
+		return;
+	}
+
+	if ( std::unique_lock lock( m_sampleMutex, std::try_to_lock ); lock )
+	{
+		evaluate( now );
+	}
+}
+
+common::ConcurrencyStats core::ConcurrencyController::getStats()
+{
+	std::scoped_lock lock( m_sampleMutex );
+	common::ConcurrencyStats stats = m_stats;
+	stats.finalWorkers = m_limit;
+	return stats;
+}
+
+void core::ConcurrencyController::evaluate( clock::time_point now )
+{
+	const clock::time_point sampleStart { clock::duration( m_sampleStart.load() ) };
+	const std::chrono::duration< double > elapsed = now - sampleStart;
+	if ( elapsed < SAMPLE_INTERVAL )
+	{
+		return;
+	}
+
+	const uint64_t operations = m_operations.exchange( 0 );
+	m_sampleStart = now.time_since_epoch().count();
+
+	const size_t active = m_active;
+	if ( operations == 0 || active == 0 )
+	{
+		return;
+	}
+
+	const double throughput = static_cast< double >( operations ) / elapsed.count();
+	const double latency = static_cast< double >( active ) / throughput;
+	m_stats.peakOpsPerSecond = std::max( m_stats.peakOpsPerSecond, static_cast< float >( throughput ) );
+
+	m_minLatency = m_minLatency == 0.0 ? latency : std::min( m_minLatency * MIN_LATENCY_DECAY, latency );
+
+	const size_t limit = m_limit;
+	if ( latency > m_minLatency * LATENCY_TOLERANCE && limit > 1 )
+	{
+		m_limit = std::max< size_t >( limit / 2, 1 );
+		++m_stats.decreases;
+	}
+	else if ( active >= limit && limit < m_maxLimit )
+	{
+		// growing only helps when every allowed worker is busy
+		m_limit = limit + 1;
+		++m_stats.increases;
+		m_stats.peakWorkers = std::max( m_stats.peakWorkers, limit + 1 );
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "common/cleaner_info.hpp"
+
+namespace core
+{
+	// AIMD limit for the workers of one device. completed operations are sampled per interval,
+	// the latency follows from Little's law as active workers divided by throughput.
+	// the limit grows by one while latency stays near the best seen and is halved once it rises
+	class ConcurrencyController
+	{
+	public:
+		explicit ConcurrencyController( size_t maxLimit );
+
+		// false when the active workers already reach the limit
+		[[nodiscard]] bool tryAcquire();
+		void release();
+		// releases the caller only while the active workers exceed the limit, so the last worker never leaves
+		[[nodiscard]] bool releaseIfOverLimit();
+
+		void recordOperations( size_t count );
+		[[nodiscard]] common::ConcurrencyStats getStats();
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		void evaluate( clock::time_point now );
+
+		const size_t m_maxLimit;
+		std::atomic< size_t > m_limit;
+		std::atomic< size_t > m_active { 0 };
+		std::atomic< uint64_t > m_operations { 0 };
+		std::atomic< clock::rep > m_sampleStart;
+
+		std::mutex m_sampleMutex;
+		double m_minLatency = 0.0;
+		common::ConcurrencyStats m_stats;
+	};
+}
\ No newline at end of file
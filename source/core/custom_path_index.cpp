@@ -0,0 +1,67 @@
+#include "custom_path_index.hpp"
+
+#include "utils/filesystem.hpp"
+
+core::CustomPathIndex::Key core::CustomPathIndex::makeKey( const fs::path& path )
+{
+	std::error_code ec;
+	fs::path canonicalPath = fs::weakly_canonical( path, ec );
+	if ( ec )
+	{
+		canonicalPath = fs::absolute( path, ec ).lexically_normal();
+	}
+
+	return { std::move( canonicalPath ), utils::getFileId( path ) };
+}
+
+common::OptionalString core::CustomPathIndex::findConflict( const Key& key ) const
+{
+	if ( key.fileId && m_fileIds.contains( *key.fileId ) )
+	{
+		return "Duplicated path";
+	}
+
+	const utils::PathTrie< uint64_t >::Match match = m_trie.findClosest( key.canonicalPath );
+	if ( match.value )
+	{
+		if ( match.exact )
+		{
+			return "Duplicated path";
+		}
+		return "Path is inside custom path " + utils::pathToString( m_keys.at( *match.value ).canonicalPath );
+	}
+
+	if ( const uint64_t* descendant = m_trie.findDescendant( key.canonicalPath ) )
+	{
+		return "Path contains custom path " + utils::pathToString( m_keys.at( *descendant ).canonicalPath );
+	}
+
+	return std::nullopt;
+}
+
+void core::CustomPathIndex::insert( uint64_t id, Key key )
+{
+	if ( key.fileId )
+	{
+		m_fileIds[ *key.fileId ] = id;
+	}
+	m_trie.insert( key.canonicalPath, id );
+	m_keys[ id ] = std::move( key );
+}
+
+void core::CustomPathIndex::erase( uint64_t id )
+{
+	auto it = m_keys.find( id );
+	if ( it == m_keys.end() )
+	{
+		return;
+	}
+
+	const Key& key = it->second;
+	if ( key.fileId )
+	{
+		m_fileIds.erase( *key.fileId );
+	}
+	m_trie.erase( key.canonicalPath );
+	m_keys.erase( it );
+}
\ No newline at end of file
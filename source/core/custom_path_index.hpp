@@ -0,0 +1,34 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "common/types.hpp"
+#include "utils/file_id.hpp"
+#include "utils/path_trie.hpp"
+
+namespace core
+{
+	// finds duplicates by file identity and overlaps by canonical path prefix without touching the other custom paths
+	class CustomPathIndex
+	{
+	public:
+		struct Key
+		{
+			fs::path canonicalPath;
+			std::optional< utils::FileId > fileId;
+		};
+
+		[[nodiscard]] static Key makeKey( const fs::path& path );
+
+		// error message if the path repeats or overlaps an indexed path
+		[[nodiscard]] common::OptionalString findConflict( const Key& key ) const;
+
+		void insert( uint64_t id, Key key );
+		void erase( uint64_t id );
+
+	private:
+		std::unordered_map< uint64_t, Key > m_keys;
+		std::unordered_map< utils::FileId, uint64_t, utils::FileIdHash > m_fileIds;
+		utils::PathTrie< uint64_t > m_trie;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/cleaner_info.hpp"
+
+namespace core
+{
+	struct DirInfo
+	{
+		void add( const DirInfo& info )
+		{
+			dirSize += info.dirSize;
+			countFile += info.countFile;
+			removedDirs += info.removedDirs;
+			pinnedFiles += info.pinnedFiles;
+			pinnedSize += info.pinnedSize;
+			specialFiles += info.specialFiles;
+			errors.add( info.errors );
+		}
+
+		uint64_t dirSize = 0;
+		uint64_t countFile = 0;
+		// empty folders pruned after cleaning
+		uint64_t removedDirs = 0;
+		// files kept because a running process holds them open
+		uint64_t pinnedFiles = 0;
+		uint64_t pinnedSize = 0;
+		// sockets and pipes found by analysis, a process may be listening on them where they are
+		uint64_t specialFiles = 0;
+		common::ErrorStats errors;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "duplicate_finder.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "core/task_manager.hpp"
+#include "utils/file_id.hpp"
+#include "utils/hash.hpp"
+
+namespace
+{
+	constexpr size_t PREFIX_SIZE = 4 * 1024;
+	constexpr size_t READ_BLOCK_SIZE = 1024 * 1024;
+
+	struct Candidate
+	{
+		fs::path path;
+		uint64_t fileSize = 0;
+		uint64_t hash = 0;
+	};
+
+	using Group = std::vector< size_t >;
+
+	// nullopt when the file can not be read, such a file is left out of its group
+	std::optional< uint64_t > hashFile( const fs::path& path, uint64_t maxSize )
+	{
+		// one buffer per thread, large reads keep the disk busy with few system calls
+		thread_local std::unique_ptr< char[] > buffer = std::make_unique< char[] >( READ_BLOCK_SIZE );
+
+		std::ifstream input( path, std::ios::binary );
+		if ( !input )
+		{
+			return std::nullopt;
+		}
+
+		utils::Hash64 hash;
+		uint64_t remaining = maxSize;
+		while ( remaining > 0 )
+		{
+			input.read( buffer.get(), static_cast< std::streamsize >( std::min< uint64_t >( remaining, READ_BLOCK_SIZE ) ) );
+			const std::streamsize readSize = input.gcount();
+			if ( readSize <= 0 )
+			{
+				break;
+			}
+
+			hash.update( buffer.get(), static_cast< size_t >( readSize ) );
+			remaining -= static_cast< uint64_t >( readSize );
+		}
+
+		if ( input.bad() )
+		{
+			return std::nullopt;
+		}
+		return hash.digest();
+	}
+
+	// splits every group by the hash of up to hashSize bytes, groups left with one file are dropped
+	std::vector< Group > splitByHash( std::vector< Candidate >& candidates, const std::vector< Group >& groups, uint64_t hashSize,
+		const std::atomic< bool >& cancelToken, const std::function< void( float ) >& onProgress, float progressStart, float progressEnd )
+	{
+		std::vector< size_t > pending;
+		for ( const Group& group : groups )
+		{
+			pending.insert( pending.end(), group.begin(), group.end() );
+		}
+
+		// bytes instead of vector< bool >, every task writes its own element
+		std::vector< uint8_t > isRead( candidates.size(), 0 );
+		std::atomic< size_t > hashedFiles { 0 };
+		core::TaskManager::instance().parallelFor( pending.size(), [ & ] ( size_t i )
+		{
+			if ( cancelToken )
+			{
+				return;
+			}
+
+			Candidate& candidate = candidates[ pending[ i ] ];
+			if ( const std::optional< uint64_t > hash = hashFile( candidate.path, std::min( candidate.fileSize, hashSize ) ) )
+			{
+				candidate.hash = hash.value();
+				isRead[ pending[ i ] ] = 1;
+			}
+
+			const float done = static_cast< float >( ++hashedFiles ) / static_cast< float >( pending.size() );
+			onProgress( progressStart + ( progressEnd - progressStart ) * done );
+		} );
+
+		std::vector< Group > result;
+		for ( const Group& group : groups )
+		{
+			std::unordered_map< uint64_t, Group > byHash;
+			for ( const size_t index : group )
+			{
+				if ( isRead[ index ] )
+				{
+					byHash[ candidates[ index ].hash ].push_back( index );
+				}
+			}
+
+			for ( Group& subGroup : byHash | std::views::values )
+			{
+				if ( subGroup.size() > 1 )
+				{
+					result.push_back( std::move( subGroup ) );
+				}
+			}
+		}
+		return result;
+	}
+}
+
+std::vector< core::DuplicateGroup > core::findDuplicates( std::vector< DuplicateCandidate > files, const std::atomic< bool >& cancelToken,
+	const std::function< void( float ) >& onProgress )
+{
+	TaskManager& taskManager = TaskManager::instance();
+
+	// only files sharing a size can be equal, empty files are not worth reporting
+	std::unordered_map< uint64_t, Group > bySize;
+	std::vector< Candidate > candidates;
+	for ( DuplicateCandidate& file : files )
+	{
+		if ( file.fileSize > 0 )
+		{
+			bySize[ file.fileSize ].push_back( candidates.size() );
+			candidates.push_back( { .path = std::move( file.path ), .fileSize = file.fileSize } );
+		}
+	}
+
+	std::vector< Group > groups;
+	std::vector< size_t > sized;
+	for ( Group& group : bySize | std::views::values )
+	{
+		if ( group.size() > 1 )
+		{
+			sized.insert( sized.end(), group.begin(), group.end() );
+			groups.push_back( std::move( group ) );
+		}
+	}
+
+	// hard links and overlapping roots reach one file through several paths, it is kept once
+	std::vector< std::optional< utils::FileId > > fileIds( candidates.size() );
+	taskManager.parallelFor( sized.size(), [ & ] ( size_t i )
+	{
+		fileIds[ sized[ i ] ] = utils::getFileId( candidates[ sized[ i ] ].path );
+	} );
+
+	for ( Group& group : groups )
+	{
+		std::unordered_set< utils::FileId, utils::FileIdHash > seen;
+		std::erase_if( group, [ & ] ( size_t index )
+		{
+			return fileIds[ index ].has_value() && !seen.insert( fileIds[ index ].value() ).second;
+		} );
+	}
+	std::erase_if( groups, [] ( const Group& group )
+	{
+		return group.size() < 2;
+	} );
+
+	groups = splitByHash( candidates, groups, PREFIX_SIZE, cancelToken, onProgress, 0.f, 0.5f );
+
+	// files not longer than the prefix are already hashed whole
+	std::vector< Group > fullGroups;
+	std::vector< Group > confirmed;
+	for ( Group& group : groups )
+	{
+		( candidates[ group.front() ].fileSize > PREFIX_SIZE ? fullGroups : confirmed ).push_back( std::move( group ) );
+	}
+
+	std::vector< Group > fullMatches = splitByHash( candidates, fullGroups, UINT64_MAX, cancelToken, onProgress, 0.5f, 1.f );
+	confirmed.insert( confirmed.end(), std::make_move_iterator( fullMatches.begin() ), std::make_move_iterator( fullMatches.end() ) );
+
+	std::vector< DuplicateGroup > duplicates;
+	duplicates.reserve( confirmed.size() );
+	for ( const Group& group : confirmed )
+	{
+		DuplicateGroup duplicate { .fileSize = candidates[ group.front() ].fileSize, .paths = {} };
+		for ( const size_t index : group )
+		{
+			duplicate.paths.push_back( std::move( candidates[ index ].path ) );
+		}
+		std::sort( duplicate.paths.begin(), duplicate.paths.end() );
+		duplicates.push_back( std::move( duplicate ) );
+	}
+
+	std::sort( duplicates.begin(), duplicates.end(), [] ( const DuplicateGroup& g1, const DuplicateGroup& g2 )
+	{
+		return g1.reclaimableSize() > g2.reclaimableSize();
+	} );
+
+	onProgress( 1.f );
+	return duplicates;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// a file the scan accepted, sizes come from the walk so the finder does not stat it again
+	struct DuplicateCandidate
+	{
+		fs::path path;
+		uint64_t fileSize = 0;
+	};
+
+	struct DuplicateGroup
+	{
+		uint64_t fileSize = 0;
+		// identical files, hard links of one file are listed once
+		std::vector< fs::path > paths;
+
+		uint64_t reclaimableSize() const noexcept
+		{
+			return fileSize * ( paths.size() - 1 );
+		}
+	};
+
+	// narrows candidates by size, then by a hash of the first block, then by a hash of the whole content.
+	// groups are ranked by reclaimable bytes, progress goes from 0 to 1 while files are hashed.
+	// once cancelled no more files are read, only groups already confirmed in full are returned
+	[[nodiscard]] std::vector< DuplicateGroup > findDuplicates( std::vector< DuplicateCandidate > files, const std::atomic< bool >& cancelToken,
+		const std::function< void( float ) >& onProgress );
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "empty_dir_tracker.hpp"
+
+#include <algorithm>
+
+#include "core/task_manager.hpp"
+
+core::EmptyDirTracker::EmptyDirTracker()
+{
+	m_nodes.push_back( std::make_unique< Node >() );
+}
+
+size_t core::EmptyDirTracker::addDirectory( fs::path path, size_t parent, bool isKept )
+{
+	addEntry( parent );
+
+	auto node = std::make_unique< Node >();
+	node->path = std::move( path );
+	node->parent = parent;
+	node->depth = m_nodes[ parent ]->depth + 1;
+	node->isKept = isKept;
+	m_nodes.push_back( std::move( node ) );
+	return m_nodes.size() - 1;
+}
+
+void core::EmptyDirTracker::addEntry( size_t dir )
+{
+	++m_nodes[ dir ]->entries;
+}
+
+void core::EmptyDirTracker::markRemoved( size_t dir )
+{
+	++m_nodes[ dir ]->removed;
+}
+
+bool core::EmptyDirTracker::isEmptied( size_t dir ) const
+{
+	const Node& node = *m_nodes[ dir ];
+	return node.removed > 0 && node.removed == node.entries;
+}
+
+uint64_t core::EmptyDirTracker::prune()
+{
+	std::vector< std::vector< Node* > > levels;
+	for ( const std::unique_ptr< Node >& node : m_nodes )
+	{
+		if ( node->depth > 0 )
+		{
+			levels.resize( std::max( levels.size(), node->depth ) );
+			levels[ node->depth - 1 ].push_back( node.get() );
+		}
+	}
+
+	// a level only starts once the deeper one is done, so every count it reads is final
+	std::atomic< uint64_t > removedDirs { 0 };
+	for ( auto level = levels.rbegin(); level != levels.rend(); ++level )
+	{
+		TaskManager::instance().parallelFor( level->size(), [ & ] ( size_t i )
+		{
+			Node& node = *( *level )[ i ];
+			if ( node.isKept || node.removed == 0 || node.removed != node.entries )
+			{
+				return;
+			}
+
+			// remove fails on a folder that got new files since the walk, such a folder is kept
+			std::error_code ec;
+			if ( fs::remove( node.path, ec ) )
+			{
+				++m_nodes[ node.parent ]->removed;
+				++removedDirs;
+			}
+		} );
+	}
+
+	return removedDirs;
+}
\ No newline at end of file
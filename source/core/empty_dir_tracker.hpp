@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// counts the entries of every directory seen by a delete pass, so the emptied ones can be removed without walking the tree again
+	class EmptyDirTracker
+	{
+	public:
+		static constexpr size_t ROOT = 0;
+
+		EmptyDirTracker();
+
+		// returns the index to pass for the entries of the new directory. a kept directory is never removed
+		size_t addDirectory( fs::path path, size_t parent, bool isKept = false );
+		void addEntry( size_t dir );
+		void markRemoved( size_t dir );
+		// all entries of the directory are gone and at least one was removed by this pass
+		[[nodiscard]] bool isEmptied( size_t dir ) const;
+
+		// removes the directories this pass emptied deepest first, one level at a time in parallel: all their entries are gone
+		// and at least one of them was removed. folders that were empty before are left alone, the root is never removed
+		[[nodiscard]] uint64_t prune();
+
+	private:
+		struct Node
+		{
+			fs::path path;
+			size_t parent = ROOT;
+			size_t depth = 0;
+			size_t entries = 0;
+			std::atomic< size_t > removed { 0 };
+			bool isKept = false;
+		};
+
+		// atomics can not be moved, so nodes are kept behind pointers
+		std::vector< std::unique_ptr< Node > > m_nodes;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "io_scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "core/concurrency_controller.hpp"
+#include "utils/device_info.hpp"
+#include "utils/file_id.hpp"
+
+namespace
+{
+	// parallel reads on a spinning disk only add seeks
+	constexpr size_t ROTATIONAL_CONCURRENCY = 1;
+
+	// controller of the queue whose work runs on this thread
+	thread_local core::ConcurrencyController* t_controller = nullptr;
+
+	// a device keeps its kind for the lifetime of the process, so every device is probed once
+	bool isRotationalDevice( uint64_t device, const fs::path& path )
+	{
+		static std::mutex mutex;
+		static std::unordered_map< uint64_t, bool > devices;
+
+		std::scoped_lock lock( mutex );
+		if ( auto it = devices.find( device ); it != devices.end() )
+		{
+			return it->second;
+		}
+
+		const bool isRotational = utils::isRotational( path ).value_or( false );
+		devices.emplace( device, isRotational );
+		return isRotational;
+	}
+
+	// items of one runBatch call, taken by whichever of the caller and its queued helpers is free
+	struct Batch
+	{
+		Batch( const std::function< void( size_t ) >& body, size_t count ) : body( body ), count( count ) {}
+
+		// a helper that starts after the last item was taken returns without touching the body
+		void run()
+		{
+			for ( size_t index = next++; index < count; index = next++ )
+			{
+				body( index );
+				if ( ++done == count )
+				{
+					std::scoped_lock lock( mutex );
+					finished.notify_all();
+				}
+			}
+		}
+
+		void wait()
+		{
+			std::unique_lock lock( mutex );
+			finished.wait( lock, [ this ] { return done == count; } );
+		}
+
+		const std::function< void( size_t ) >& body;
+		const size_t count;
+		std::atomic< size_t > next { 0 };
+		std::atomic< size_t > done { 0 };
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+}
+
+struct core::IoScheduler::DeviceQueue : std::enable_shared_from_this< DeviceQueue >
+{
+	DeviceQueue( size_t maxWorkers, TaskGroup& group ) : maxWorkers( maxWorkers ), controller( maxWorkers ), group( group ) {}
+
+	bool hasWork()
+	{
+		std::scoped_lock lock( mutex );
+		return !works.empty();
+	}
+
+	std::function< void() > pop()
+	{
+		std::scoped_lock lock( mutex );
+		if ( works.empty() )
+		{
+			return {};
+		}
+
+		std::function< void() > work = std::move( works.front() );
+		works.pop_front();
+		return work;
+	}
+
+	std::mutex mutex;
+	// batch helpers are pushed to the front, the work that started them is waiting
+	std::deque< std::function< void() > > works;
+	const size_t maxWorkers;
+	ConcurrencyController controller;
+	TaskGroup& group;
+
+	// queue whose work runs on this thread
+	static thread_local DeviceQueue* current;
+};
+
+thread_local core::IoScheduler::DeviceQueue* core::IoScheduler::DeviceQueue::current = nullptr;
+
+core::IoScheduler::IoScheduler( TaskGroup& group ) : m_group( group )
+{
+}
+
+void core::IoScheduler::schedule( std::vector< IoWork > works )
+{
+	struct Entry
+	{
+		uint64_t inode = 0;
+		IoWork work;
+	};
+
+	// missing roots have no device and share the queue of device 0
+	std::map< uint64_t, std::vector< Entry > > byDevice;
+	for ( IoWork& work : works )
+	{
+		const utils::FileId fileId = utils::getFileId( work.root ).value_or( utils::FileId {} );
+		byDevice[ fileId.device ].push_back( { fileId.inode, std::move( work ) } );
+	}
+
+	const size_t threadCount = TaskManager::instance().getThreadCount();
+	for ( auto& [ device, entries ] : byDevice )
+	{
+		const bool isRotational = device != 0 && isRotationalDevice( device, entries.front().work.root );
+		if ( isRotational )
+		{
+			// inode numbers roughly follow the on-disk layout, walking in their order shortens the head movement
+			std::sort( entries.begin(), entries.end(), [] ( const Entry& e1, const Entry& e2 )
+			{
+				return e1.inode < e2.inode;
+			} );
+		}
+
+		auto queue = std::make_shared< DeviceQueue >( isRotational ? ROTATIONAL_CONCURRENCY : threadCount, m_group );
+		for ( Entry& entry : entries )
+		{
+			queue->works.push_back( std::move( entry.work.body ) );
+		}
+
+		m_queues.push_back( queue );
+		spawnWorkers( queue );
+	}
+}
+
+void core::IoScheduler::runBatch( size_t count, const std::function< void( size_t ) >& body )
+{
+	// a spinning disk keeps its single worker, the items run in order on this thread
+	DeviceQueue* queue = DeviceQueue::current;
+	const size_t helperCount = queue && count > 1 ? std::min( count, queue->maxWorkers ) - 1 : 0;
+	if ( helperCount == 0 )
+	{
+		for ( size_t index = 0; index < count; ++index )
+		{
+			body( index );
+		}
+		return;
+	}
+
+	auto batch = std::make_shared< Batch >( body, count );
+	{
+		std::scoped_lock lock( queue->mutex );
+		for ( size_t i = 0; i < helperCount; ++i )
+		{
+			queue->works.push_front( [ batch ] ()
+			{
+				batch->run();
+			} );
+		}
+	}
+	spawnWorkers( queue->shared_from_this() );
+
+	batch->run();
+	batch->wait();
+}
+
+void core::IoScheduler::spawnWorkers( const std::shared_ptr< DeviceQueue >& queue )
+{
+	while ( queue->hasWork() && queue->controller.tryAcquire() )
+	{
+		queue->group.run( [ queue ] ()
+		{
+			runWorker( queue );
+		} );
+	}
+}
+
+void core::IoScheduler::runWorker( const std::shared_ptr< DeviceQueue >& queue )
+{
+	ConcurrencyController* outerController = std::exchange( t_controller, &queue->controller );
+	DeviceQueue* outerQueue = std::exchange( DeviceQueue::current, queue.get() );
+	bool isReleased = false;
+	while ( const std::function< void() > work = queue->pop() )
+	{
+		work();
+
+		// the limit may have changed while the work ran, a raised one is filled with new workers
+		if ( queue->controller.releaseIfOverLimit() )
+		{
+			isReleased = true;
+			break;
+		}
+		spawnWorkers( queue );
+	}
+	DeviceQueue::current = outerQueue;
+	t_controller = outerController;
+
+	if ( !isReleased )
+	{
+		// a batch may have queued helpers after the queue was seen empty, while this slot was still taken
+		queue->controller.release();
+		spawnWorkers( queue );
+	}
+}
+
+common::ConcurrencyStats core::IoScheduler::getStats() const
+{
+	common::ConcurrencyStats stats;
+	for ( const std::shared_ptr< DeviceQueue >& queue : m_queues )
+	{
+		const common::ConcurrencyStats queueStats = queue->controller.getStats();
+		stats.peakWorkers += queueStats.peakWorkers;
+		stats.finalWorkers += queueStats.finalWorkers;
+		stats.increases += queueStats.increases;
+		stats.decreases += queueStats.decreases;
+		stats.peakOpsPerSecond += queueStats.peakOpsPerSecond;
+	}
+	return stats;
+}
+
+void core::recordIoOperations( size_t count )
+{
+	if ( t_controller )
+	{
+		t_controller->recordOperations( count );
+	}
+}
\ No newline at end of file
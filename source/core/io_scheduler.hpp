@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "common/cleaner_info.hpp"
+#include "core/task_manager.hpp"
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	struct IoWork
+	{
+		// the folder or file the work reads, it decides the device queue
+		fs::path root;
+		std::function< void() > body;
+	};
+
+	// queues the work per device. a rotational disk gets one worker and its roots in inode order,
+	// on other devices the number of workers is adapted to the measured throughput
+	class IoScheduler
+	{
+	public:
+		explicit IoScheduler( TaskGroup& group );
+
+		void schedule( std::vector< IoWork > works );
+		// valid once the group is done
+		[[nodiscard]] common::ConcurrencyStats getStats() const;
+
+		// runs body( i ) for every i and returns when all are done. inside scheduled work the items are offered to the
+		// workers of the same device queue, so its limit decides how many run at once. elsewhere they run on this thread
+		static void runBatch( size_t count, const std::function< void( size_t ) >& body );
+
+	private:
+		struct DeviceQueue;
+
+		static void spawnWorkers( const std::shared_ptr< DeviceQueue >& queue );
+		static void runWorker( const std::shared_ptr< DeviceQueue >& queue );
+
+		TaskGroup& m_group;
+		std::vector< std::shared_ptr< DeviceQueue > > m_queues;
+	};
+
+	// counts finished filesystem operations for the controller of the device being worked on, no-op outside scheduled work
+	void recordIoOperations( size_t count = 1 );
+}
\ No newline at end of file
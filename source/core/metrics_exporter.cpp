@@ -0,0 +1,234 @@
+#include "metrics_exporter.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace
+{
+	constexpr std::string_view METRIC_PREFIX = "systemcleaner_";
+	constexpr std::string_view RUN_NAMES[] = { "analysis", "cleaning" };
+	constexpr float MIN_DURATION = 0.001f;
+
+	using Labels = std::initializer_list< std::pair< std::string_view, std::string_view > >;
+
+	void appendFamily( std::string& out, std::string_view name, std::string_view help )
+	{
+		out += "# HELP ";
+		out += METRIC_PREFIX;
+		out += name;
+		out += ' ';
+		out += help;
+		out += "\n# TYPE ";
+		out += METRIC_PREFIX;
+		out += name;
+		out += " gauge\n";
+	}
+
+	// backslash, quote and line feed are the only escapes of the text format
+	void appendLabelValue( std::string& out, std::string_view value )
+	{
+		for ( const char c : value )
+		{
+			if ( c == '\\' || c == '"' )
+			{
+				out += '\\';
+				out += c;
+			}
+			else if ( c == '\n' )
+			{
+				out += "\\n";
+			}
+			else
+			{
+				out += c;
+			}
+		}
+	}
+
+	template< typename T >
+	void appendSample( std::string& out, std::string_view name, Labels labels, T value )
+	{
+		out += METRIC_PREFIX;
+		out += name;
+		if ( labels.size() != 0 )
+		{
+			char separator = '{';
+			for ( const auto& [ key, labelValue ] : labels )
+			{
+				out += separator;
+				out += key;
+				out += "=\"";
+				appendLabelValue( out, labelValue );
+				out += '"';
+				separator = ',';
+			}
+			out += '}';
+		}
+
+		char digits[ 32 ];
+		const std::to_chars_result result = std::to_chars( std::begin( digits ), std::end( digits ), value );
+		out += ' ';
+		out.append( digits, result.ptr );
+		out += '\n';
+	}
+
+	void appendOptions( std::string& out, std::string_view name, const std::vector< common::CleanResult >& results, std::string_view help, bool isBytes )
+	{
+		if ( results.empty() )
+		{
+			return;
+		}
+
+		// two results can share item and option, e.g. custom paths ending in the same folder name. the collector rejects a
+		// file with a repeated series, so their figures are summed into one sample
+		std::map< std::pair< std::string_view, std::string_view >, uint64_t > totals;
+		for ( const common::CleanResult& result : results )
+		{
+			totals[ { result.propertyName, result.categoryName } ] += isBytes ? result.cleanedSize : result.cleanedFiles;
+		}
+
+		appendFamily( out, name, help );
+		for ( const auto& [ labels, total ] : totals )
+		{
+			appendSample( out, name, { { "item", labels.first }, { "option", labels.second } }, total );
+		}
+	}
+}
+
+void core::MetricsExporter::setPath( std::optional< fs::path > path )
+{
+	std::scoped_lock lock( m_mutex );
+	m_path = std::move( path );
+}
+
+void core::MetricsExporter::recordFound( const common::Summary& summary )
+{
+	std::scoped_lock lock( m_mutex );
+	if ( m_path.has_value() )
+	{
+		m_found = summary.results;
+	}
+}
+
+bool core::MetricsExporter::finishRun( const common::Summary& summary )
+{
+	std::scoped_lock lock( m_mutex );
+	if ( !m_path.has_value() )
+	{
+		return true;
+	}
+
+	const bool isCleaning = summary.type == common::SummaryType::CLEANING;
+	RunMetrics& run = m_runs[ isCleaning ? CLEANING : ANALYSIS ];
+	run.hasRun = true;
+	run.isCancelled = summary.isCancelled;
+	run.duration = summary.totalTime;
+	run.files = summary.totalFiles;
+	run.bytes = summary.totalSize;
+	run.errors = summary.errors;
+
+	// a cut short run keeps the per-option figures of the last complete one
+	if ( !summary.isCancelled )
+	{
+		run.lastSuccess = std::chrono::system_clock::now();
+		( isCleaning ? m_removed : m_found ) = summary.results;
+	}
+
+	return write();
+}
+
+bool core::MetricsExporter::write() const
+{
+	std::string text;
+	appendOptions( text, "option_found_bytes", m_found, "Bytes found in the option by the latest analysis.", true );
+	appendOptions( text, "option_found_files", m_found, "Files found in the option by the latest analysis.", false );
+	appendOptions( text, "option_removed_bytes", m_removed, "Bytes removed from the option by the latest cleaning.", true );
+	appendOptions( text, "option_removed_files", m_removed, "Files removed from the option by the latest cleaning.", false );
+
+	auto appendRuns = [ this, &text ] ( std::string_view name, std::string_view help, auto value )
+	{
+		appendFamily( text, name, help );
+		for ( size_t i = 0; i < m_runs.size(); ++i )
+		{
+			if ( m_runs[ i ].hasRun )
+			{
+				appendSample( text, name, { { "run", RUN_NAMES[ i ] } }, value( m_runs[ i ] ) );
+			}
+		}
+	};
+
+	appendRuns( "run_duration_seconds", "Duration of the latest run.", [] ( const RunMetrics& run )
+	{
+		return static_cast< double >( run.duration );
+	} );
+	appendRuns( "run_throughput_bytes_per_second", "Bytes handled per second by the latest run.", [] ( const RunMetrics& run )
+	{
+		return run.duration < MIN_DURATION ? 0.0 : static_cast< double >( run.bytes ) / run.duration;
+	} );
+	appendRuns( "run_throughput_files_per_second", "Files handled per second by the latest run.", [] ( const RunMetrics& run )
+	{
+		return run.duration < MIN_DURATION ? 0.0 : static_cast< double >( run.files ) / run.duration;
+	} );
+	appendRuns( "run_cancelled", "1 when the latest run was cancelled or timed out.", [] ( const RunMetrics& run )
+	{
+		return run.isCancelled ? 1 : 0;
+	} );
+
+	appendFamily( text, "run_errors", "Filesystem errors skipped over by the latest run." );
+	for ( size_t i = 0; i < m_runs.size(); ++i )
+	{
+		if ( !m_runs[ i ].hasRun )
+		{
+			continue;
+		}
+
+		const common::ErrorStats& errors = m_runs[ i ].errors;
+		const std::pair< std::string_view, uint64_t > classes[] =
+		{
+			{ "denied", errors.denied },
+			{ "busy", errors.busy },
+			{ "missing", errors.missing },
+			{ "other", errors.other }
+		};
+		for ( const auto& [ errorClass, count ] : classes )
+		{
+			appendSample( text, "run_errors", { { "run", RUN_NAMES[ i ] }, { "class", errorClass } }, count );
+		}
+	}
+
+	appendFamily( text, "last_success_timestamp_seconds", "Unix time the latest complete run finished." );
+	for ( size_t i = 0; i < m_runs.size(); ++i )
+	{
+		if ( m_runs[ i ].lastSuccess.has_value() )
+		{
+			const auto seconds = std::chrono::duration_cast< std::chrono::seconds >( m_runs[ i ].lastSuccess->time_since_epoch() );
+			appendSample( text, "last_success_timestamp_seconds", { { "run", RUN_NAMES[ i ] } }, seconds.count() );
+		}
+	}
+
+	// the collector only reads *.prom, the temporary file next to it is skipped
+	fs::path tempPath = *m_path;
+	tempPath += ".tmp";
+	{
+		std::ofstream output( tempPath, std::ios::binary | std::ios::trunc );
+		output.write( text.data(), text.size() );
+		if ( !output )
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	fs::rename( tempPath, *m_path, ec );
+	if ( ec )
+	{
+		fs::remove( tempPath, ec );
+		return false;
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "common/cleaner_info.hpp"
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// keeps the latest analysis and cleaning figures and writes them as a Prometheus textfile collector file.
+	// the file is written beside its target and renamed over it, so a scrape never sees half of it
+	class MetricsExporter
+	{
+	public:
+		// the file should end in .prom and sit in the collector's directory, nullopt turns the export off
+		void setPath( std::optional< fs::path > path );
+
+		// found sizes of a cleaning run, taken before its cleaning pass replaces the results
+		void recordFound( const common::Summary& summary );
+		// stores the finished run and rewrites the file, false when it could not be written
+		bool finishRun( const common::Summary& summary );
+
+	private:
+		struct RunMetrics
+		{
+			bool hasRun = false;
+			bool isCancelled = false;
+			float duration = 0.f;
+			uint64_t files = 0;
+			uint64_t bytes = 0;
+			common::ErrorStats errors;
+			std::optional< std::chrono::system_clock::time_point > lastSuccess;
+		};
+
+		enum RunKind
+		{
+			ANALYSIS,
+			CLEANING,
+			RUN_KIND_COUNT
+		};
+
+		[[nodiscard]] bool write() const;
+
+		std::mutex m_mutex;
+		std::optional< fs::path > m_path;
+		std::array< RunMetrics, RUN_KIND_COUNT > m_runs;
+		std::vector< common::CleanResult > m_found;
+		std::vector< common::CleanResult > m_removed;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "open_file_index.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "core/task_manager.hpp"
+#include "utils/filesystem.hpp"
+
+namespace
+{
+#ifndef _WIN32
+	std::vector< std::string > listProcesses()
+	{
+		std::vector< std::string > pids;
+		DIR* proc = opendir( "/proc" );
+		if ( !proc )
+		{
+			return pids;
+		}
+
+		while ( const dirent* entry = readdir( proc ) )
+		{
+			char* end = nullptr;
+			std::strtoul( entry->d_name, &end, 10 );
+			if ( end != entry->d_name && *end == '\0' )
+			{
+				pids.emplace_back( entry->d_name );
+			}
+		}
+		closedir( proc );
+		return pids;
+	}
+
+	struct ProcessFiles
+	{
+		std::vector< utils::FileId > fileIds;
+		std::vector< std::string > paths;
+	};
+
+	// plain readdir and fstatat, the descriptor links are resolved by the kernel without building paths.
+	// the link text is only read when paths are asked for
+	void collectOpenFiles( const std::string& pid, ProcessFiles& files, bool withPaths )
+	{
+		DIR* fdDir = opendir( ( "/proc/" + pid + "/fd" ).c_str() );
+		if ( !fdDir )
+		{
+			return;
+		}
+
+		const int dirFd = dirfd( fdDir );
+		while ( const dirent* entry = readdir( fdDir ) )
+		{
+			struct stat st {};
+			if ( entry->d_name[ 0 ] == '.' || fstatat( dirFd, entry->d_name, &st, 0 ) != 0 || !S_ISREG( st.st_mode ) )
+			{
+				continue;
+			}
+
+			files.fileIds.push_back( { static_cast< uint64_t >( st.st_dev ), static_cast< uint64_t >( st.st_ino ) } );
+			if ( withPaths )
+			{
+				// an unlinked file is named "path (deleted)" and lies nowhere any more
+				char target[ PATH_MAX ];
+				const ssize_t size = readlinkat( dirFd, entry->d_name, target, sizeof( target ) );
+				const std::string_view path( target, size > 0 ? static_cast< size_t >( size ) : 0 );
+				if ( path.starts_with( '/' ) && !path.ends_with( " (deleted)" ) )
+				{
+					files.paths.emplace_back( path );
+				}
+			}
+		}
+		closedir( fdDir );
+	}
+#endif
+}
+
+core::OpenFileIndex core::OpenFileIndex::build( bool withPaths )
+{
+	OpenFileIndex index;
+#ifndef _WIN32
+	const std::vector< std::string > pids = listProcesses();
+
+	std::vector< ProcessFiles > processFiles( pids.size() );
+	TaskManager::instance().parallelFor( pids.size(), [ & ] ( size_t i )
+	{
+		collectOpenFiles( pids[ i ], processFiles[ i ], withPaths );
+	} );
+
+	for ( ProcessFiles& files : processFiles )
+	{
+		index.m_fileIds.insert( files.fileIds.begin(), files.fileIds.end() );
+		index.m_paths.insert( index.m_paths.end(), std::make_move_iterator( files.paths.begin() ), std::make_move_iterator( files.paths.end() ) );
+	}
+	std::sort( index.m_paths.begin(), index.m_paths.end() );
+#endif
+	return index;
+}
+
+bool core::OpenFileIndex::isBusyError( const std::error_code& error )
+{
+#ifdef _WIN32
+	return error.value() == ERROR_SHARING_VIOLATION || error.value() == ERROR_LOCK_VIOLATION;
+#else
+	return error.value() == EBUSY || error.value() == ETXTBSY;
+#endif
+}
+
+bool core::OpenFileIndex::contains( const utils::FileId& fileId ) const
+{
+	return m_fileIds.contains( fileId );
+}
+
+bool core::OpenFileIndex::hasFilesUnder( const fs::path& dir ) const
+{
+	if ( m_paths.empty() )
+	{
+		return false;
+	}
+
+	// the kernel names files by their resolved path
+	std::error_code ec;
+	const fs::path canonical = fs::weakly_canonical( dir, ec );
+	std::string prefix = utils::pathToString( ec ? dir : canonical );
+	if ( !prefix.ends_with( '/' ) )
+	{
+		prefix += '/';
+	}
+
+	const auto it = std::lower_bound( m_paths.begin(), m_paths.end(), prefix );
+	return it != m_paths.end() && it->starts_with( prefix );
+}
+
+size_t core::OpenFileIndex::size() const noexcept
+{
+	return m_fileIds.size();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+
+#include "utils/file_id.hpp"
+
+namespace core
+{
+	// files held open by running processes. their space stays allocated after unlinking, so cleaning leaves them in place
+	class OpenFileIndex
+	{
+	public:
+		// scans /proc/*/fd of every process in parallel. processes of other users are only visible with enough rights.
+		// Windows has no cheap equivalent, there the index stays empty and a locked file is detected by isBusyError.
+		// withPaths also reads where each file was opened, for hasFilesUnder
+		[[nodiscard]] static OpenFileIndex build( bool withPaths = false );
+
+		// an error from deleting a file that another process has open
+		[[nodiscard]] static bool isBusyError( const std::error_code& error );
+
+		// takes the identity the caller already has, so a lookup costs no stat of its own
+		[[nodiscard]] bool contains( const utils::FileId& fileId ) const;
+		// an open file lies below dir. only an index built withPaths knows, a file renamed since it was opened is missed
+		[[nodiscard]] bool hasFilesUnder( const fs::path& dir ) const;
+		[[nodiscard]] size_t size() const noexcept;
+
+	private:
+		std::unordered_set< utils::FileId, utils::FileIdHash > m_fileIds;
+		// sorted, so the files below a folder are one range
+		std::vector< std::string > m_paths;
+	};
+}
\ No newline at end of file
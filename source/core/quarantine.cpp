@@ -0,0 +1,330 @@
+#include "quarantine.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	constexpr uint32_t MAX_SAVED_PATH_SIZE = 32768;
+	constexpr std::string_view QUARANTINE_SUFFIX = ".quarantine-";
+
+	// utf-8, so names outside the code page survive a restart
+	void writePath( std::ofstream& output, const fs::path& path )
+	{
+		const std::u8string str = path.u8string();
+		const uint32_t size = static_cast< uint32_t >( str.size() );
+		output.write( reinterpret_cast< const char* >( &size ), sizeof( size ) );
+		output.write( reinterpret_cast< const char* >( str.data() ), size );
+	}
+
+	bool readPath( std::ifstream& input, fs::path& path )
+	{
+		uint32_t size = 0;
+		if ( !input.read( reinterpret_cast< char* >( &size ), sizeof( size ) ) || size > MAX_SAVED_PATH_SIZE )
+		{
+			return false;
+		}
+
+		std::u8string str( size, u8'\0' );
+		if ( !input.read( reinterpret_cast< char* >( str.data() ), size ) )
+		{
+			return false;
+		}
+		path = fs::path( str );
+		return true;
+	}
+
+	std::vector< fs::path > listChildren( const fs::path& path )
+	{
+		std::vector< fs::path > children;
+		std::error_code ec;
+		try
+		{
+			for ( const fs::directory_entry& entry : fs::directory_iterator( path, ec ) )
+			{
+				children.push_back( entry.path() );
+			}
+		}
+		catch ( const fs::filesystem_error& ) {}
+		return children;
+	}
+
+	// moves what is not there back into place, folders present on both sides are merged
+	void mergeBack( const fs::path& from, const fs::path& to )
+	{
+		for ( const fs::path& child : listChildren( from ) )
+		{
+			const fs::path target = to / child.filename();
+			std::error_code ec;
+			if ( !fs::exists( target, ec ) )
+			{
+				fs::rename( child, target, ec );
+			}
+			else if ( fs::is_directory( target, ec ) && fs::is_directory( child, ec ) )
+			{
+				mergeBack( child, target );
+			}
+		}
+	}
+
+	// stops at the first child that can not be moved, the caller puts back what moved until then
+	bool moveChildren( const fs::path& from, const fs::path& to, std::span< const std::string_view > keptDirs )
+	{
+		// listed first, renaming entries out of a folder while reading it may skip some
+		std::error_code ec;
+		std::vector< fs::path > children;
+		for ( fs::directory_iterator it( from, ec ), end; !ec && it != end; it.increment( ec ) )
+		{
+			children.push_back( it->path() );
+		}
+		if ( ec )
+		{
+			return false;
+		}
+
+		for ( const fs::path& child : children )
+		{
+			const fs::path target = to / child.filename();
+			const bool isKept = fs::is_directory( fs::symlink_status( child, ec ) ) && std::any_of( keptDirs.begin(), keptDirs.end(),
+				[ &child ] ( std::string_view name )
+				{
+					return child.filename() == fs::path( name );
+				} );
+
+			if ( isKept )
+			{
+				fs::create_directory( target, child, ec );
+				if ( ec || !moveChildren( child, target, keptDirs ) )
+				{
+					return false;
+				}
+			}
+			else
+			{
+				fs::rename( child, target, ec );
+				if ( ec )
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool restoreTree( const fs::path& original, const fs::path& moved )
+	{
+		// a folder option kept its own folder, its children are merged back into it
+		std::error_code ec;
+		if ( !fs::exists( original, ec ) )
+		{
+			fs::rename( moved, original, ec );
+			return !ec;
+		}
+
+		// files written at the old place since are newer, only the moved files they replace are dropped
+		mergeBack( moved, original );
+		fs::remove_all( moved, ec );
+		return true;
+	}
+}
+
+core::Quarantine::Quarantine( fs::path listPath ) : m_listPath( std::move( listPath ) )
+{
+	load();
+}
+
+bool core::Quarantine::move( const fs::path& path, std::span< const std::string_view > keptDirs )
+{
+	// "dir/" names the folder itself
+	const fs::path source = path.has_filename() ? path : path.parent_path();
+	std::error_code ec;
+	const bool isDirectory = fs::is_directory( source, ec );
+
+	// a sibling is on the same volume, so the renames neither copy nor walk anything
+	fs::path moved = source;
+	moved += QUARANTINE_SUFFIX;
+	moved += std::to_string( std::chrono::system_clock::now().time_since_epoch().count() );
+	{
+		std::scoped_lock lock( m_mutex );
+		m_entries.push_back( { source, moved, std::chrono::steady_clock::now(), State::MOVING } );
+		save();
+	}
+
+	if ( isDirectory )
+	{
+		// the new folder takes the attributes of the option's folder
+		fs::create_directory( moved, source, ec );
+		if ( !ec && !moveChildren( source, moved, keptDirs ) )
+		{
+			// the option must not lose part of its files to a clear that failed
+			mergeBack( moved, source );
+			ec = std::make_error_code( std::errc::io_error );
+		}
+	}
+	else
+	{
+		fs::rename( source, moved, ec );
+	}
+
+	std::scoped_lock lock( m_mutex );
+	auto it = std::find_if( m_entries.begin(), m_entries.end(), [ &moved ] ( const Entry& entry )
+	{
+		return entry.moved == moved;
+	} );
+	if ( ec )
+	{
+		// what could not be put back stays listed, it can still be restored or purged
+		std::error_code removeError;
+		fs::remove( moved, removeError );
+		if ( fs::exists( moved, removeError ) )
+		{
+			it->state = State::MOVED;
+		}
+		else
+		{
+			m_entries.erase( it );
+		}
+		save();
+		return false;
+	}
+
+	it->state = State::MOVED;
+	return true;
+}
+
+size_t core::Quarantine::restore()
+{
+	std::vector< Entry > restoring;
+	{
+		std::scoped_lock lock( m_mutex );
+		for ( Entry& entry : m_entries )
+		{
+			if ( entry.state == State::MOVED )
+			{
+				entry.state = State::RESTORING;
+				restoring.push_back( entry );
+			}
+		}
+	}
+
+	std::vector< fs::path > restored;
+	for ( const Entry& entry : restoring )
+	{
+		if ( restoreTree( entry.original, entry.moved ) )
+		{
+			restored.push_back( entry.moved );
+		}
+	}
+
+	// a tree that could not be put back stays listed for the next undo or purge
+	std::scoped_lock lock( m_mutex );
+	std::erase_if( m_entries, [ &restored ] ( const Entry& entry )
+	{
+		return entry.state == State::RESTORING && std::find( restored.begin(), restored.end(), entry.moved ) != restored.end();
+	} );
+	for ( Entry& entry : m_entries )
+	{
+		entry.state = entry.state == State::RESTORING ? State::MOVED : entry.state;
+	}
+
+	save();
+	return restored.size();
+}
+
+void core::Quarantine::purge( std::chrono::steady_clock::time_point movedBefore )
+{
+	while ( !m_isStopped )
+	{
+		fs::path moved;
+		{
+			std::scoped_lock lock( m_mutex );
+			auto it = std::find_if( m_entries.begin(), m_entries.end(), [ movedBefore ] ( const Entry& entry )
+			{
+				return entry.state == State::MOVED && entry.movedAt <= movedBefore;
+			} );
+			if ( it == m_entries.end() )
+			{
+				return;
+			}
+
+			// restore leaves it alone from now on
+			it->state = State::PURGING;
+			moved = it->moved;
+		}
+
+		// removed one child at a time, so stop does not wait for a whole tree
+		std::error_code ec;
+		for ( const fs::path& child : listChildren( moved ) )
+		{
+			if ( m_isStopped )
+			{
+				break;
+			}
+			fs::remove_all( child, ec );
+		}
+
+		if ( !m_isStopped )
+		{
+			fs::remove_all( moved, ec );
+		}
+
+		// a tree that could not be removed stays listed, the next session tries again
+		std::scoped_lock lock( m_mutex );
+		if ( !fs::exists( moved, ec ) )
+		{
+			std::erase_if( m_entries, [ &moved ] ( const Entry& entry )
+			{
+				return entry.moved == moved;
+			} );
+			save();
+		}
+	}
+}
+
+void core::Quarantine::stop()
+{
+	m_isStopped = true;
+}
+
+bool core::Quarantine::isEmpty() const
+{
+	std::scoped_lock lock( m_mutex );
+	return std::none_of( m_entries.begin(), m_entries.end(), [] ( const Entry& entry )
+	{
+		return entry.state == State::MOVED;
+	} );
+}
+
+void core::Quarantine::load()
+{
+	std::ifstream input( m_listPath, std::ios::binary );
+	Entry entry;
+	while ( readPath( input, entry.original ) && readPath( input, entry.moved ) )
+	{
+		// due at once, an undo does not outlive the session
+		std::error_code ec;
+		if ( fs::exists( entry.moved, ec ) )
+		{
+			m_entries.push_back( { entry.original, entry.moved, std::chrono::steady_clock::time_point::min() } );
+		}
+	}
+}
+
+void core::Quarantine::save() const
+{
+	std::error_code ec;
+	if ( m_entries.empty() )
+	{
+		fs::remove( m_listPath, ec );
+		return;
+	}
+
+	fs::create_directories( m_listPath.parent_path(), ec );
+	std::ofstream output( m_listPath, std::ios::binary | std::ios::trunc );
+	for ( const Entry& entry : m_entries )
+	{
+		writePath( output, entry.original );
+		writePath( output, entry.moved );
+	}
+}
\ No newline at end of file
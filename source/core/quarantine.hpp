@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// options cleared by renaming their contents into a folder next to them. the moved trees are deleted later at low priority,
+	// until then they can be put back. the list survives restarts, trees left by a previous session are purged first
+	class Quarantine
+	{
+	public:
+		explicit Quarantine( fs::path listPath );
+
+		// renames the children of path into a folder next to it, path itself stays with its inode, owner and watches.
+		// folders named in keptDirs stay too and only their children move. a file path is renamed as a whole.
+		// false when a rename fails, e.g. the parent is read-only, what moved until then is put back.
+		// open files inside are not looked for, they move along
+		bool move( const fs::path& path, std::span< const std::string_view > keptDirs = {} );
+		// puts the moved trees back, files created at the old place in the meantime are kept. returns the restored count.
+		// the trees are moved without holding the list, moves and purges going on meanwhile are not held up
+		size_t restore();
+		// deletes the trees moved up to movedBefore, one after the other
+		void purge( std::chrono::steady_clock::time_point movedBefore );
+		// a purge in progress stops at its next folder, the rest is left for the next session
+		void stop();
+
+		[[nodiscard]] bool isEmpty() const;
+
+	private:
+		enum class State
+		{
+			// listed before the rename, so a crash right after it leaves no unlisted tree behind
+			MOVING,
+			MOVED,
+			RESTORING,
+			PURGING
+		};
+
+		struct Entry
+		{
+			fs::path original;
+			fs::path moved;
+			std::chrono::steady_clock::time_point movedAt;
+			State state = State::MOVED;
+		};
+
+		void load();
+		// called with the mutex held
+		void save() const;
+
+		fs::path m_listPath;
+		mutable std::mutex m_mutex;
+		std::vector< Entry > m_entries;
+		std::atomic< bool > m_isStopped { false };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "report_writer.hpp"
+
+#include <charconv>
+
+namespace
+{
+	// the buffer is written out once it grows past this, so memory stays flat however many rows there are
+	constexpr size_t FLUSH_SIZE = 1 << 20;
+
+	constexpr std::string_view CSV_HEADER = "run,level,item,option,path,files,bytes\n";
+	constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+	void appendNumber( std::string& out, uint64_t value )
+	{
+		char digits[ 20 ];
+		const std::to_chars_result result = std::to_chars( std::begin( digits ), std::end( digits ), value );
+		out.append( digits, result.ptr );
+	}
+
+	// quoted only when needed, quotes inside are doubled
+	void appendCsvField( std::string& out, std::string_view value )
+	{
+		if ( value.find_first_of( ",\"\r\n" ) == std::string_view::npos )
+		{
+			out += value;
+			return;
+		}
+
+		out += '"';
+		for ( const char c : value )
+		{
+			if ( c == '"' )
+			{
+				out += '"';
+			}
+			out += c;
+		}
+		out += '"';
+	}
+
+	void appendJsonString( std::string& out, std::string_view value )
+	{
+		out += '"';
+		for ( const char c : value )
+		{
+			const unsigned char code = static_cast< unsigned char >( c );
+			if ( c == '"' || c == '\\' )
+			{
+				out += '\\';
+				out += c;
+			}
+			else if ( code < 0x20 )
+			{
+				out += "\\u00";
+				out += HEX_DIGITS[ code >> 4 ];
+				out += HEX_DIGITS[ code & 0xF ];
+			}
+			else
+			{
+				out += c;
+			}
+		}
+		out += '"';
+	}
+
+	void formatCsv( std::string& out, const core::ReportRow& row )
+	{
+		for ( const std::string_view field : { row.run, row.level, row.item, row.option, row.path } )
+		{
+			appendCsvField( out, field );
+			out += ',';
+		}
+		appendNumber( out, row.files );
+		out += ',';
+		appendNumber( out, row.bytes );
+		out += '\n';
+	}
+
+	void formatJson( std::string& out, const core::ReportRow& row )
+	{
+		const std::pair< std::string_view, std::string_view > fields[] =
+		{
+			{ "{\"run\":", row.run },
+			{ ",\"level\":", row.level },
+			{ ",\"item\":", row.item },
+			{ ",\"option\":", row.option },
+			{ ",\"path\":", row.path }
+		};
+
+		for ( const auto& [ key, value ] : fields )
+		{
+			out += key;
+			appendJsonString( out, value );
+		}
+		out += ",\"files\":";
+		appendNumber( out, row.files );
+		out += ",\"bytes\":";
+		appendNumber( out, row.bytes );
+		out += "}\n";
+	}
+}
+
+core::ReportWriter::~ReportWriter()
+{
+	close();
+}
+
+bool core::ReportWriter::open( const ReportSettings& settings )
+{
+	close();
+
+	std::scoped_lock lock( m_mutex );
+	std::error_code ec;
+	if ( settings.path.has_parent_path() )
+	{
+		fs::create_directories( settings.path.parent_path(), ec );
+	}
+
+	m_output.open( settings.path, std::ios::binary | std::ios::trunc );
+	if ( !m_output )
+	{
+		return false;
+	}
+
+	m_format = settings.format;
+	m_detail = settings.detail;
+	m_buffer.reserve( FLUSH_SIZE + FLUSH_SIZE / 4 );
+	if ( m_format == ReportFormat::CSV )
+	{
+		m_buffer += CSV_HEADER;
+	}
+	m_isOpen = true;
+	return true;
+}
+
+void core::ReportWriter::write( const ReportRow& row )
+{
+	if ( !m_isOpen )
+	{
+		return;
+	}
+
+	// formatting happens outside the lock, the line is reused by the thread
+	thread_local std::string line;
+	line.clear();
+	if ( m_format == ReportFormat::CSV )
+	{
+		formatCsv( line, row );
+	}
+	else
+	{
+		formatJson( line, row );
+	}
+
+	std::scoped_lock lock( m_mutex );
+	m_buffer += line;
+	if ( m_buffer.size() >= FLUSH_SIZE )
+	{
+		flushBuffer();
+	}
+}
+
+void core::ReportWriter::close()
+{
+	std::scoped_lock lock( m_mutex );
+	if ( !m_isOpen )
+	{
+		return;
+	}
+
+	flushBuffer();
+	m_output.close();
+	m_isOpen = false;
+}
+
+bool core::ReportWriter::isOpen() const noexcept
+{
+	return m_isOpen;
+}
+
+bool core::ReportWriter::wants( ReportDetail detail ) const noexcept
+{
+	return m_isOpen && detail <= m_detail;
+}
+
+void core::ReportWriter::flushBuffer()
+{
+	m_output.write( m_buffer.data(), static_cast< std::streamsize >( m_buffer.size() ) );
+	m_buffer.clear();
+}
\ No newline at end of file
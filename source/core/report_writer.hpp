@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	enum class ReportFormat
+	{
+		CSV,
+		JSON_LINES
+	};
+
+	enum class ReportDetail
+	{
+		OPTIONS,
+		DIRECTORIES,
+		FILES
+	};
+
+	struct ReportSettings
+	{
+		fs::path path;
+		ReportFormat format = ReportFormat::CSV;
+		ReportDetail detail = ReportDetail::OPTIONS;
+	};
+
+	struct ReportRow
+	{
+		// "analysis" or "cleaning"
+		std::string_view run;
+		// "option", "directory" or "file"
+		std::string_view level;
+		std::string_view item;
+		std::string_view option;
+		std::string_view path;
+		uint64_t files = 0;
+		uint64_t bytes = 0;
+	};
+
+	// streams report rows to a file while a run is going on. each row is formatted by the calling thread,
+	// only the append to the buffer is locked, and the buffer goes to the file in large writes
+	class ReportWriter
+	{
+	public:
+		ReportWriter() = default;
+		~ReportWriter();
+		ReportWriter( const ReportWriter& ) = delete;
+		ReportWriter& operator=( const ReportWriter& ) = delete;
+
+		// truncates the file and writes the CSV header, false when it can not be created
+		bool open( const ReportSettings& settings );
+		void write( const ReportRow& row );
+		void close();
+
+		[[nodiscard]] bool isOpen() const noexcept;
+		// rows finer than this are not wanted by the reader
+		[[nodiscard]] bool wants( ReportDetail detail ) const noexcept;
+
+	private:
+		void flushBuffer();
+
+		std::mutex m_mutex;
+		std::ofstream m_output;
+		std::string m_buffer;
+		ReportFormat m_format = ReportFormat::CSV;
+		ReportDetail m_detail = ReportDetail::OPTIONS;
+		std::atomic< bool > m_isOpen { false };
+	};
+}
\ No newline at end of file
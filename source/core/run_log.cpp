@@ -0,0 +1,487 @@
+#include "run_log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#include "utils/hash.hpp"
+
+namespace
+{
+	constexpr uint32_t RUN_LOG_VERSION = 1;
+
+	// past this the log is compacted: recent runs stay as they are, older ones are thinned out
+	constexpr uint64_t MAX_LOG_SIZE = 4 << 20;
+	constexpr uint64_t COMPACT_TARGET_SIZE = MAX_LOG_SIZE / 2;
+	constexpr int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+	constexpr int64_t FULL_HISTORY_SECONDS = 180 * SECONDS_PER_DAY;
+	// runs older than the full history keep one of each type per bucket
+	constexpr int64_t COMPACT_BUCKET_SECONDS = 7 * SECONDS_PER_DAY;
+	constexpr double MAX_PROJECTION_DAYS = 100 * 365.0;
+
+	// frame: kind, payload size, payload, low half of the payload hash
+	enum class FrameKind : uint8_t
+	{
+		NAME = 1,
+		RUN = 2
+	};
+
+	constexpr size_t FRAME_OVERHEAD = sizeof( uint8_t ) + sizeof( uint32_t ) + sizeof( uint32_t );
+	constexpr size_t RUN_HEADER_SIZE = sizeof( int64_t ) + sizeof( uint8_t ) + sizeof( float ) + sizeof( uint32_t );
+	constexpr size_t RUN_OPTION_SIZE = sizeof( uint32_t ) + sizeof( uint64_t ) + sizeof( uint64_t );
+
+	struct StoredOption
+	{
+		uint32_t nameId = 0;
+		uint64_t files = 0;
+		uint64_t bytes = 0;
+	};
+
+	struct StoredRun
+	{
+		int64_t seconds = 0;
+		common::SummaryType type = common::SummaryType::NONE;
+		float duration = 0.f;
+		std::vector< StoredOption > options;
+	};
+
+	struct LogContents
+	{
+		std::vector< std::string > names;
+		std::vector< StoredRun > runs;
+		// a torn or unreadable tail starts here, zero when the header itself is not ours
+		size_t validSize = 0;
+	};
+
+	// least squares state updated one point at a time, it stays exact over years of byte counts
+	struct TrendAccumulator
+	{
+		void add( double x, double y )
+		{
+			++count;
+			const double dx = x - meanX;
+			meanX += dx / count;
+			meanY += ( y - meanY ) / count;
+			coMoment += dx * ( y - meanY );
+			squares += dx * ( x - meanX );
+		}
+
+		size_t count = 0;
+		double meanX = 0.0;
+		double meanY = 0.0;
+		double coMoment = 0.0;
+		double squares = 0.0;
+		uint64_t lastBytes = 0;
+		int64_t lastSeconds = 0;
+	};
+
+	template< typename T >
+	void put( std::string& out, const T& value )
+	{
+		out.append( reinterpret_cast< const char* >( &value ), sizeof( value ) );
+	}
+
+	template< typename T >
+	bool get( const uint8_t*& data, const uint8_t* end, T& value )
+	{
+		if ( static_cast< size_t >( end - data ) < sizeof( T ) )
+		{
+			return false;
+		}
+		std::memcpy( &value, data, sizeof( T ) );
+		data += sizeof( T );
+		return true;
+	}
+
+	uint32_t checksum( const void* data, size_t size )
+	{
+		return static_cast< uint32_t >( utils::hash64( data, size ) );
+	}
+
+	void putFrame( std::string& out, FrameKind kind, std::string_view payload )
+	{
+		put( out, static_cast< uint8_t >( kind ) );
+		put( out, static_cast< uint32_t >( payload.size() ) );
+		out += payload;
+		put( out, checksum( payload.data(), payload.size() ) );
+	}
+
+	void putRun( std::string& out, const StoredRun& run )
+	{
+		std::string payload;
+		payload.reserve( RUN_HEADER_SIZE + run.options.size() * RUN_OPTION_SIZE );
+		put( payload, run.seconds );
+		put( payload, static_cast< uint8_t >( run.type ) );
+		put( payload, run.duration );
+		put( payload, static_cast< uint32_t >( run.options.size() ) );
+		for ( const StoredOption& option : run.options )
+		{
+			put( payload, option.nameId );
+			put( payload, option.files );
+			put( payload, option.bytes );
+		}
+		putFrame( out, FrameKind::RUN, payload );
+	}
+
+	bool parseRun( const uint8_t* data, const uint8_t* end, size_t nameCount, StoredRun& run )
+	{
+		uint8_t type = 0;
+		uint32_t count = 0;
+		if ( !get( data, end, run.seconds ) || !get( data, end, type ) || !get( data, end, run.duration ) || !get( data, end, count ) ||
+			count != static_cast< size_t >( end - data ) / RUN_OPTION_SIZE )
+		{
+			return false;
+		}
+
+		run.type = static_cast< common::SummaryType >( type );
+		run.options.resize( count );
+		for ( StoredOption& option : run.options )
+		{
+			if ( !get( data, end, option.nameId ) || !get( data, end, option.files ) || !get( data, end, option.bytes ) || option.nameId >= nameCount )
+			{
+				return false;
+			}
+		}
+		return data == end;
+	}
+
+	LogContents readLog( const fs::path& path )
+	{
+		LogContents contents;
+		std::ifstream input( path, std::ios::binary | std::ios::ate );
+		if ( !input )
+		{
+			return contents;
+		}
+
+		const std::streamoff size = input.tellg();
+		if ( size < static_cast< std::streamoff >( sizeof( RUN_LOG_VERSION ) ) )
+		{
+			return contents;
+		}
+
+		// the whole log is read in one go, compaction keeps it to a few megabytes
+		std::vector< uint8_t > buffer( static_cast< size_t >( size ) );
+		input.seekg( 0 );
+		if ( !input.read( reinterpret_cast< char* >( buffer.data() ), buffer.size() ) )
+		{
+			return contents;
+		}
+
+		const uint8_t* data = buffer.data();
+		const uint8_t* end = data + buffer.size();
+		uint32_t version = 0;
+		if ( !get( data, end, version ) || version != RUN_LOG_VERSION )
+		{
+			return contents;
+		}
+		contents.validSize = sizeof( version );
+
+		while ( data != end )
+		{
+			uint8_t kind = 0;
+			uint32_t payloadSize = 0;
+			if ( !get( data, end, kind ) || !get( data, end, payloadSize ) || payloadSize > static_cast< size_t >( end - data ) )
+			{
+				break;
+			}
+
+			const uint8_t* payload = data;
+			data += payloadSize;
+			uint32_t storedChecksum = 0;
+			if ( !get( data, end, storedChecksum ) || storedChecksum != checksum( payload, payloadSize ) )
+			{
+				break;
+			}
+
+			if ( kind == static_cast< uint8_t >( FrameKind::NAME ) )
+			{
+				contents.names.emplace_back( reinterpret_cast< const char* >( payload ), payloadSize );
+			}
+			else if ( kind == static_cast< uint8_t >( FrameKind::RUN ) )
+			{
+				StoredRun run;
+				if ( !parseRun( payload, payload + payloadSize, contents.names.size(), run ) )
+				{
+					break;
+				}
+				contents.runs.push_back( std::move( run ) );
+			}
+			else
+			{
+				break;
+			}
+
+			contents.validSize = static_cast< size_t >( data - buffer.data() );
+		}
+
+		// appends come from one process in order, a changed clock is the only way to break it
+		std::stable_sort( contents.runs.begin(), contents.runs.end(), [] ( const StoredRun& r1, const StoredRun& r2 )
+		{
+			return r1.seconds < r2.seconds;
+		} );
+		return contents;
+	}
+
+	std::chrono::system_clock::time_point toTimePoint( int64_t seconds )
+	{
+		return std::chrono::system_clock::time_point( std::chrono::seconds( seconds ) );
+	}
+}
+
+core::RunLog::RunLog( fs::path path ) : m_path( std::move( path ) )
+{
+}
+
+bool core::RunLog::append( const RunEntry& entry )
+{
+	std::scoped_lock lock( m_mutex );
+	if ( !m_isLoaded )
+	{
+		load();
+	}
+
+	std::error_code ec;
+	const uint64_t logSize = fs::file_size( m_path, ec );
+	if ( !ec && logSize > MAX_LOG_SIZE )
+	{
+		compact();
+	}
+
+	StoredRun run;
+	run.seconds = std::chrono::duration_cast< std::chrono::seconds >( entry.time.time_since_epoch() ).count();
+	run.type = entry.type;
+	run.duration = entry.duration;
+
+	// new names go in front of the run that uses them, so one write carries both
+	std::string frames;
+	for ( const RunOptionEntry& option : entry.options )
+	{
+		const auto [ it, isNew ] = m_nameIds.try_emplace( option.option, static_cast< uint32_t >( m_nameIds.size() ) );
+		if ( isNew )
+		{
+			putFrame( frames, FrameKind::NAME, option.option );
+		}
+		run.options.push_back( { it->second, option.files, option.bytes } );
+	}
+	putRun( frames, run );
+
+	std::ofstream output( m_path, std::ios::binary | std::ios::app );
+	output.write( frames.data(), frames.size() );
+	output.flush();
+	if ( !output )
+	{
+		// the names may be half written, the next append trims the tail and reads them again
+		m_isLoaded = false;
+		return false;
+	}
+	return true;
+}
+
+std::vector< core::RunEntry > core::RunLog::readAll() const
+{
+	LogContents contents;
+	{
+		std::scoped_lock lock( m_mutex );
+		contents = readLog( m_path );
+	}
+
+	std::vector< RunEntry > entries;
+	entries.reserve( contents.runs.size() );
+	for ( const StoredRun& run : contents.runs )
+	{
+		RunEntry& entry = entries.emplace_back();
+		entry.type = run.type;
+		entry.time = toTimePoint( run.seconds );
+		entry.duration = run.duration;
+		for ( const StoredOption& option : run.options )
+		{
+			entry.options.push_back( { contents.names[ option.nameId ], option.files, option.bytes } );
+		}
+	}
+	return entries;
+}
+
+std::vector< core::OptionTrend > core::RunLog::queryTrends( uint64_t thresholdBytes ) const
+{
+	LogContents contents;
+	{
+		std::scoped_lock lock( m_mutex );
+		contents = readLog( m_path );
+	}
+
+	if ( contents.runs.empty() )
+	{
+		return {};
+	}
+
+	// days are counted from the first run, so the sums stay small
+	const int64_t origin = contents.runs.front().seconds;
+	std::vector< TrendAccumulator > accumulators( contents.names.size() );
+	for ( const StoredRun& run : contents.runs )
+	{
+		for ( const StoredOption& option : run.options )
+		{
+			TrendAccumulator& accumulator = accumulators[ option.nameId ];
+			if ( run.type == common::SummaryType::CLEANING )
+			{
+				// growth starts over from an emptied target
+				accumulator = {};
+			}
+			else if ( run.type == common::SummaryType::ANALYSIS )
+			{
+				accumulator.add( static_cast< double >( run.seconds - origin ) / SECONDS_PER_DAY, static_cast< double >( option.bytes ) );
+				accumulator.lastBytes = option.bytes;
+				accumulator.lastSeconds = run.seconds;
+			}
+		}
+	}
+
+	std::vector< OptionTrend > trends;
+	for ( size_t i = 0; i < accumulators.size(); ++i )
+	{
+		const TrendAccumulator& accumulator = accumulators[ i ];
+		if ( accumulator.count == 0 )
+		{
+			continue;
+		}
+
+		OptionTrend& trend = trends.emplace_back();
+		trend.option = contents.names[ i ];
+		trend.lastBytes = accumulator.lastBytes;
+		trend.lastTime = toTimePoint( accumulator.lastSeconds );
+		trend.bytesPerDay = accumulator.squares > 0.0 ? accumulator.coMoment / accumulator.squares : 0.0;
+
+		if ( trend.lastBytes >= thresholdBytes )
+		{
+			trend.thresholdTime = trend.lastTime;
+		}
+		else if ( trend.bytesPerDay > 0.0 )
+		{
+			const double days = static_cast< double >( thresholdBytes - trend.lastBytes ) / trend.bytesPerDay;
+			if ( days < MAX_PROJECTION_DAYS )
+			{
+				const std::chrono::duration< double, std::ratio< SECONDS_PER_DAY > > untilThreshold( days );
+				trend.thresholdTime = trend.lastTime + std::chrono::duration_cast< std::chrono::system_clock::duration >( untilThreshold );
+			}
+		}
+	}
+
+	std::sort( trends.begin(), trends.end(), [] ( const OptionTrend& t1, const OptionTrend& t2 )
+	{
+		return t1.bytesPerDay > t2.bytesPerDay;
+	} );
+	return trends;
+}
+
+void core::RunLog::load()
+{
+	const LogContents contents = readLog( m_path );
+
+	m_nameIds.clear();
+	for ( size_t i = 0; i < contents.names.size(); ++i )
+	{
+		m_nameIds.emplace( contents.names[ i ], static_cast< uint32_t >( i ) );
+	}
+
+	std::error_code ec;
+	fs::create_directories( m_path.parent_path(), ec );
+	if ( contents.validSize == 0 )
+	{
+		// missing, or written by another version
+		std::ofstream output( m_path, std::ios::binary | std::ios::trunc );
+		output.write( reinterpret_cast< const char* >( &RUN_LOG_VERSION ), sizeof( RUN_LOG_VERSION ) );
+	}
+	else if ( fs::file_size( m_path, ec ) > contents.validSize )
+	{
+		// an append cut short by a crash, later frames would never be reached behind it
+		fs::resize_file( m_path, contents.validSize, ec );
+	}
+
+	m_isLoaded = true;
+}
+
+bool core::RunLog::compact()
+{
+	LogContents contents = readLog( m_path );
+
+	// the newest run of each type per bucket survives outside the full history
+	const int64_t fullHistoryStart = contents.runs.empty() ? 0 : contents.runs.back().seconds - FULL_HISTORY_SECONDS;
+	std::set< std::pair< common::SummaryType, int64_t > > keptBuckets;
+	std::vector< StoredRun > runs;
+	for ( auto it = contents.runs.rbegin(); it != contents.runs.rend(); ++it )
+	{
+		if ( it->seconds < fullHistoryStart && !keptBuckets.emplace( it->type, it->seconds / COMPACT_BUCKET_SECONDS ).second )
+		{
+			continue;
+		}
+		runs.push_back( std::move( *it ) );
+	}
+	std::reverse( runs.begin(), runs.end() );
+
+	// a log still too large after thinning loses its oldest runs
+	uint64_t totalSize = 0;
+	for ( const StoredRun& run : runs )
+	{
+		totalSize += FRAME_OVERHEAD + RUN_HEADER_SIZE + run.options.size() * RUN_OPTION_SIZE;
+	}
+
+	size_t firstRun = 0;
+	while ( firstRun < runs.size() && totalSize > COMPACT_TARGET_SIZE )
+	{
+		totalSize -= FRAME_OVERHEAD + RUN_HEADER_SIZE + runs[ firstRun ].options.size() * RUN_OPTION_SIZE;
+		++firstRun;
+	}
+
+	// names are numbered again, the ones only dropped runs used are gone
+	std::vector< uint32_t > newIds( contents.names.size(), UINT32_MAX );
+	std::vector< std::string_view > usedNames;
+	std::string log;
+	put( log, RUN_LOG_VERSION );
+	for ( size_t i = firstRun; i < runs.size(); ++i )
+	{
+		for ( StoredOption& option : runs[ i ].options )
+		{
+			uint32_t& newId = newIds[ option.nameId ];
+			if ( newId == UINT32_MAX )
+			{
+				newId = static_cast< uint32_t >( usedNames.size() );
+				usedNames.push_back( contents.names[ option.nameId ] );
+				putFrame( log, FrameKind::NAME, usedNames.back() );
+			}
+			option.nameId = newId;
+		}
+		putRun( log, runs[ i ] );
+	}
+
+	fs::path tempPath = m_path;
+	tempPath += ".tmp";
+	{
+		std::ofstream output( tempPath, std::ios::binary | std::ios::trunc );
+		output.write( log.data(), log.size() );
+		if ( !output )
+		{
+			return false;
+		}
+	}
+
+	// the full log is rotated out once, the compacted one takes its place in a single rename
+	std::error_code ec;
+	fs::path rotatedPath = m_path;
+	rotatedPath += ".old";
+	fs::copy_file( m_path, rotatedPath, fs::copy_options::overwrite_existing, ec );
+	fs::rename( tempPath, m_path, ec );
+	if ( ec )
+	{
+		fs::remove( tempPath, ec );
+		return false;
+	}
+
+	m_nameIds.clear();
+	for ( size_t i = 0; i < usedNames.size(); ++i )
+	{
+		m_nameIds.emplace( usedNames[ i ], static_cast< uint32_t >( i ) );
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/cleaner_info.hpp"
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	struct RunOptionEntry
+	{
+		// "item/option" of the summary result
+		std::string option;
+		uint64_t files = 0;
+		uint64_t bytes = 0;
+	};
+
+	struct RunEntry
+	{
+		common::SummaryType type = common::SummaryType::NONE;
+		std::chrono::system_clock::time_point time;
+		float duration = 0.f;
+		std::vector< RunOptionEntry > options;
+	};
+
+	struct OptionTrend
+	{
+		std::string option;
+		uint64_t lastBytes = 0;
+		std::chrono::system_clock::time_point lastTime;
+		// least squares over the analyses since the option was last cleaned, zero below two of them
+		double bytesPerDay = 0.0;
+		// when the option reaches the threshold at this rate, nullopt when it does not grow
+		std::optional< std::chrono::system_clock::time_point > thresholdTime;
+	};
+
+	// append-only history of finished runs. option names are written once and referenced by index afterwards,
+	// every frame is checksummed so a torn append loses only itself
+	class RunLog
+	{
+	public:
+		explicit RunLog( fs::path path );
+
+		// compacts the log first once it is over its size limit
+		bool append( const RunEntry& entry );
+
+		[[nodiscard]] std::vector< RunEntry > readAll() const;
+		// every option analysed since its last cleaning, fastest growing first
+		[[nodiscard]] std::vector< OptionTrend > queryTrends( uint64_t thresholdBytes ) const;
+
+	private:
+		void load();
+		bool compact();
+
+		fs::path m_path;
+		mutable std::mutex m_mutex;
+
+		// name index of the file on disk, loaded before the first append
+		std::unordered_map< std::string, uint32_t > m_nameIds;
+		bool m_isLoaded = false;
+	};
+}
\ No newline at end of file
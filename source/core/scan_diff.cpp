@@ -0,0 +1,144 @@
+#include "scan_diff.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <queue>
+
+#include "core/scan_snapshot.hpp"
+
+namespace
+{
+	struct GrowthGreater
+	{
+		bool operator()( const core::GrowthEntry& e1, const core::GrowthEntry& e2 ) const
+		{
+			return e1.sizeDelta > e2.sizeDelta;
+		}
+	};
+
+	// min-heap on growth, the smallest kept entry is evicted first
+	using TopDirectories = std::priority_queue< core::GrowthEntry, std::vector< core::GrowthEntry >, GrowthGreater >;
+
+	int compareKeys( const core::DirRecord& r1, const core::DirRecord& r2 )
+	{
+		if ( int cmp = r1.option.compare( r2.option ); cmp != 0 )
+		{
+			return cmp;
+		}
+		return r1.directory.compare( r2.directory );
+	}
+
+	std::optional< core::DirRecord > readNext( core::SnapshotReader& reader )
+	{
+		core::DirRecord record;
+		if ( reader.next( record ) )
+		{
+			return record;
+		}
+		return std::nullopt;
+	}
+}
+
+core::ScanDiff core::diffSnapshots( const fs::path& previous, const fs::path& current, size_t maxDirectories )
+{
+	ScanDiff diff;
+
+	SnapshotReader previousReader( previous );
+	SnapshotReader currentReader( current );
+	if ( !currentReader )
+	{
+		return diff;
+	}
+	diff.hasPrevious = static_cast< bool >( previousReader );
+
+	TopDirectories topDirectories;
+	GrowthEntry optionGrowth;
+	bool hasOption = false;
+	// an option sized as a whole on either side has no directory figures to compare
+	bool isOptionTotal = false;
+
+	auto flushOption = [ & ] ()
+	{
+		if ( hasOption && ( optionGrowth.sizeDelta != 0 || optionGrowth.filesDelta != 0 ) )
+		{
+			diff.options.push_back( std::move( optionGrowth ) );
+		}
+		hasOption = false;
+	};
+
+	auto addDelta = [ & ] ( const DirRecord& record, int64_t sizeDelta, int64_t filesDelta )
+	{
+		if ( !hasOption || optionGrowth.option != record.option )
+		{
+			flushOption();
+			optionGrowth = { .option = record.option, .directory = {} };
+			hasOption = true;
+			isOptionTotal = false;
+		}
+
+		// the total sorts before the directories of its option, so it is seen first
+		isOptionTotal = isOptionTotal || record.directory.empty();
+
+		optionGrowth.sizeDelta += sizeDelta;
+		optionGrowth.filesDelta += filesDelta;
+		diff.totalSizeDelta += sizeDelta;
+		diff.totalFilesDelta += filesDelta;
+
+		if ( sizeDelta <= 0 || maxDirectories == 0 || isOptionTotal )
+		{
+			return;
+		}
+
+		if ( topDirectories.size() == maxDirectories )
+		{
+			if ( topDirectories.top().sizeDelta >= sizeDelta )
+			{
+				return;
+			}
+			topDirectories.pop();
+		}
+		topDirectories.push( { record.option, record.directory, sizeDelta, filesDelta } );
+	};
+
+	std::optional< DirRecord > prev = readNext( previousReader );
+	std::optional< DirRecord > curr = readNext( currentReader );
+
+	while ( prev || curr )
+	{
+		const int cmp = !prev ? 1 : !curr ? -1 : compareKeys( *prev, *curr );
+		if ( cmp < 0 )
+		{
+			addDelta( *prev, -static_cast< int64_t >( prev->dirSize ), -static_cast< int64_t >( prev->countFile ) );
+			prev = readNext( previousReader );
+		}
+		else if ( cmp > 0 )
+		{
+			addDelta( *curr, static_cast< int64_t >( curr->dirSize ), static_cast< int64_t >( curr->countFile ) );
+			curr = readNext( currentReader );
+		}
+		else
+		{
+			addDelta( *curr, static_cast< int64_t >( curr->dirSize ) - static_cast< int64_t >( prev->dirSize ),
+				static_cast< int64_t >( curr->countFile ) - static_cast< int64_t >( prev->countFile ) );
+			prev = readNext( previousReader );
+			curr = readNext( currentReader );
+		}
+	}
+	flushOption();
+
+	diff.directories.reserve( topDirectories.size() );
+	while ( !topDirectories.empty() )
+	{
+		diff.directories.push_back( topDirectories.top() );
+		topDirectories.pop();
+	}
+	std::reverse( diff.directories.begin(), diff.directories.end() );
+
+	std::stable_sort( diff.options.begin(), diff.options.end(),
+	[] ( const GrowthEntry& e1, const GrowthEntry& e2 )
+	{
+		return e1.sizeDelta > e2.sizeDelta;
+	} );
+
+	return diff;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	struct GrowthEntry
+	{
+		std::string option;
+		std::string directory;
+		int64_t sizeDelta = 0;
+		int64_t filesDelta = 0;
+	};
+
+	struct ScanDiff
+	{
+		bool hasPrevious = false;
+		int64_t totalSizeDelta = 0;
+		int64_t totalFilesDelta = 0;
+
+		// both lists are ranked by growth in bytes
+		std::vector< GrowthEntry > options;
+		std::vector< GrowthEntry > directories;
+	};
+
+	// merges two snapshots written by SnapshotWriter, keeps only the maxDirectories fastest growing directories
+	[[nodiscard]] ScanDiff diffSnapshots( const fs::path& previous, const fs::path& current, size_t maxDirectories );
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "scan_snapshot.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+	constexpr uint32_t SNAPSHOT_VERSION = 1;
+	constexpr uint32_t MAX_STRING_SIZE = 32768;
+	constexpr std::string_view RUN_EXTENSION = ".run";
+
+	void writeString( std::ofstream& output, const std::string& str )
+	{
+		const uint32_t size = static_cast< uint32_t >( str.size() );
+		output.write( reinterpret_cast< const char* >( &size ), sizeof( size ) );
+		output.write( str.data(), size );
+	}
+
+	void writeRecord( std::ofstream& output, const core::DirRecord& record )
+	{
+		writeString( output, record.option );
+		writeString( output, record.directory );
+		output.write( reinterpret_cast< const char* >( &record.dirSize ), sizeof( record.dirSize ) );
+		output.write( reinterpret_cast< const char* >( &record.countFile ), sizeof( record.countFile ) );
+	}
+
+	bool recordLess( const core::DirRecord& r1, const core::DirRecord& r2 )
+	{
+		return std::tie( r1.option, r1.directory ) < std::tie( r2.option, r2.directory );
+	}
+}
+
+core::SnapshotWriter::SnapshotWriter( fs::path runDir ) : m_runDir( std::move( runDir ) )
+{
+}
+
+void core::SnapshotWriter::addOption( const std::string& option, DirRecords records )
+{
+	std::sort( records.begin(), records.end(), recordLess );
+
+	fs::path runPath;
+	{
+		std::scoped_lock lock( m_mutex );
+		runPath = m_runDir / std::to_string( m_nextRun++ ).append( RUN_EXTENSION );
+		m_runs[ option ].push_back( runPath );
+	}
+
+	std::error_code ec;
+	fs::create_directories( m_runDir, ec );
+	std::ofstream output( runPath, std::ios::binary | std::ios::trunc );
+	output.write( reinterpret_cast< const char* >( &SNAPSHOT_VERSION ), sizeof( SNAPSHOT_VERSION ) );
+	for ( const DirRecord& record : records )
+	{
+		writeRecord( output, record );
+	}
+}
+
+void core::SnapshotWriter::clear()
+{
+	std::scoped_lock lock( m_mutex );
+	m_runs.clear();
+
+	// also takes the files a crashed session left
+	std::error_code ec;
+	fs::remove_all( m_runDir, ec );
+}
+
+bool core::SnapshotWriter::finish( const fs::path& path, const fs::path& basePath )
+{
+	std::map< std::string, std::vector< fs::path > > runs;
+	{
+		std::scoped_lock lock( m_mutex );
+		runs.swap( m_runs );
+	}
+
+	std::ofstream output( path, std::ios::binary | std::ios::trunc );
+	if ( output )
+	{
+		output.write( reinterpret_cast< const char* >( &SNAPSHOT_VERSION ), sizeof( SNAPSHOT_VERSION ) );
+	}
+
+	SnapshotReader base( basePath );
+	DirRecord baseRecord;
+	auto nextBase = [ & ] ()
+	{
+		while ( base.next( baseRecord ) )
+		{
+			if ( !runs.contains( baseRecord.option ) )
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// options come in key order and never overlap, so each one is streamed in turn. an option added more than once
+	// holds one record per file in memory while its files are merged
+	bool hasBase = output && nextBase();
+	for ( const auto& [ option, runPaths ] : runs )
+	{
+		while ( hasBase && baseRecord.option < option )
+		{
+			writeRecord( output, baseRecord );
+			hasBase = nextBase();
+		}
+
+		std::vector< SnapshotReader > readers;
+		std::vector< DirRecord > heads( runPaths.size() );
+		std::vector< bool > hasHead( runPaths.size() );
+		readers.reserve( runPaths.size() );
+		for ( size_t i = 0; i < runPaths.size(); ++i )
+		{
+			hasHead[ i ] = readers.emplace_back( runPaths[ i ] ).next( heads[ i ] );
+		}
+
+		for ( ;; )
+		{
+			size_t first = runPaths.size();
+			for ( size_t i = 0; i < runPaths.size(); ++i )
+			{
+				if ( hasHead[ i ] && ( first == runPaths.size() || recordLess( heads[ i ], heads[ first ] ) ) )
+				{
+					first = i;
+				}
+			}
+			if ( first == runPaths.size() )
+			{
+				break;
+			}
+
+			writeRecord( output, heads[ first ] );
+			hasHead[ first ] = readers[ first ].next( heads[ first ] );
+		}
+	}
+
+	while ( hasBase )
+	{
+		writeRecord( output, baseRecord );
+		hasBase = nextBase();
+	}
+
+	std::error_code ec;
+	fs::remove_all( m_runDir, ec );
+	return static_cast< bool >( output );
+}
+
+core::SnapshotReader::SnapshotReader( const fs::path& path ) : m_input( path, std::ios::binary )
+{
+	uint32_t version = 0;
+	m_valid = m_input.read( reinterpret_cast< char* >( &version ), sizeof( version ) ) && version == SNAPSHOT_VERSION;
+}
+
+bool core::SnapshotReader::next( DirRecord& record )
+{
+	if ( !m_valid )
+	{
+		return false;
+	}
+
+	m_valid = readString( record.option ) && readString( record.directory ) &&
+		m_input.read( reinterpret_cast< char* >( &record.dirSize ), sizeof( record.dirSize ) ) &&
+		m_input.read( reinterpret_cast< char* >( &record.countFile ), sizeof( record.countFile ) );
+
+	return m_valid;
+}
+
+bool core::SnapshotReader::readString( std::string& str )
+{
+	uint32_t size = 0;
+	if ( !m_input.read( reinterpret_cast< char* >( &size ), sizeof( size ) ) || size > MAX_STRING_SIZE )
+	{
+		return false;
+	}
+
+	str.resize( size );
+	return size == 0 || static_cast< bool >( m_input.read( str.data(), size ) );
+}
\ No newline at end of file
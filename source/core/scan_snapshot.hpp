@@ -0,0 +1,67 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	struct DirRecord
+	{
+		std::string option;
+		// empty for a total of the whole option, e.g. read from a cache index. it is never ranked as a directory
+		std::string directory;
+		uint64_t dirSize = 0;
+		uint64_t countFile = 0;
+	};
+
+	using DirRecords = std::vector< DirRecord >;
+
+	// collects the records of a run as one sorted file per option, so only the option being added is held in memory.
+	// the snapshot is sorted by option and directory, the reader relies on this order
+	class SnapshotWriter
+	{
+	public:
+		// the option files are kept in runDir until finish or clear
+		explicit SnapshotWriter( fs::path runDir );
+
+		// sorts the records of one finished option and writes them aside, called from the workers
+		void addOption( const std::string& option, DirRecords records );
+		// drops what was added
+		void clear();
+		// streams the added options into path, options not added are carried over from basePath
+		bool finish( const fs::path& path, const fs::path& basePath );
+
+	private:
+		fs::path m_runDir;
+		std::mutex m_mutex;
+		// an option key can be added more than once, its files are merged then
+		std::map< std::string, std::vector< fs::path > > m_runs;
+		size_t m_nextRun = 0;
+	};
+
+	class SnapshotReader
+	{
+	public:
+		explicit SnapshotReader( const fs::path& path );
+
+		explicit operator bool() const
+		{
+			return m_valid;
+		}
+
+		// reads one record at a time, so the whole snapshot is never held in memory
+		[[nodiscard]] bool next( DirRecord& record );
+
+	private:
+		bool readString( std::string& str );
+
+		std::ifstream m_input;
+		bool m_valid = false;
+	};
+}
\ No newline at end of file
@@ -1,34 +1,116 @@
 #include "system_cleaner.hpp"
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <ranges>
+#include <stdexcept>
+#include <utility>
 
 #include "common/constants.hpp"
+#include "core/browser_discovery.hpp"
+#include "core/cache_index.hpp"
+#include "core/duplicate_finder.hpp"
+#include "core/empty_dir_tracker.hpp"
+#include "core/io_scheduler.hpp"
 #include "core/task_manager.hpp"
+#include "core/trash.hpp"
 #include "utils/filesystem.hpp"
+#include "utils/glob.hpp"
 #include "utils/path_validator.hpp"
 
 
 namespace
 {
 	constexpr std::string_view RECYCLE_BIN = "Recycle bin";
-	constexpr std::string_view CACHE = "Cache";
-	constexpr std::string_view HISTORY = "History";
+
+	constexpr std::string_view REPORT_ANALYSIS = "analysis";
+	constexpr std::string_view REPORT_CLEANING = "cleaning";
+	constexpr std::string_view REPORT_OPTION = "option";
+	constexpr std::string_view REPORT_DIRECTORY = "directory";
+	constexpr std::string_view REPORT_FILE = "file";
 
 	constexpr float EPS = 0.001f;
+	constexpr std::chrono::milliseconds PROGRESS_NOTIFY_INTERVAL( 50 );
+	constexpr size_t MAX_GROWTH_DIRECTORIES = 50;
+	constexpr size_t MAX_DUPLICATE_RESULTS = 500;
+	constexpr uint32_t MAX_SAVED_PATH_SIZE = 10000;
+	constexpr std::chrono::seconds TARGETS_POLL_INTERVAL( 2 );
+	// how long a quarantine clear can be undone
+	constexpr std::chrono::minutes QUARANTINE_PURGE_DELAY( 5 );
+
+	// browsers expect these folders of their caches to exist, emptying them does not remove them
+	constexpr std::array< std::string_view, 9 > STRUCTURAL_CACHE_DIRS =
+	{
+		"Cache_Data", "Code Cache", "GPUCache", "cache2", "doomed", "entries", "index-dir", "js", "wasm"
+	};
 
-	const fs::path CONFIG_DIR = utils::FileSystem::instance().getRoamingAppDataDir() / "SystemCleaner";
+	const fs::path CONFIG_DIR = utils::FileSystem::instance().getConfigDir();
 	const fs::path SAVING_PATH = CONFIG_DIR / "custom_paths.bin";
+	const fs::path CURRENT_SNAPSHOT_PATH = CONFIG_DIR / "scan_current.snap";
+	const fs::path PREVIOUS_SNAPSHOT_PATH = CONFIG_DIR / "scan_previous.snap";
+	const fs::path SNAPSHOT_RUNS_DIR = CONFIG_DIR / "scan_runs";
+	const fs::path RUN_LOG_PATH = CONFIG_DIR / "run_log.bin";
+	const fs::path TARGETS_PATH = CONFIG_DIR / "targets.ini";
+	const fs::path QUARANTINE_PATH = CONFIG_DIR / "quarantine.bin";
+
+	std::optional< fs::file_time_type > getWriteTime( const fs::path& path )
+	{
+		std::error_code ec;
+		const fs::file_time_type writeTime = fs::last_write_time( path, ec );
+		return ec ? std::nullopt : std::optional( writeTime );
+	}
+
+	// temp folders are shared by every process, the sockets and lock files in them have to stay where their owners look
+	bool isInSharedTemp( const fs::path& path )
+	{
+		std::error_code ec;
+		std::vector< fs::path > tempDirs { fs::temp_directory_path( ec ) };
+#ifndef _WIN32
+		tempDirs.insert( tempDirs.end(), { "/tmp", "/var/tmp", "/dev/shm" } );
+#endif
+
+		const fs::path canonical = fs::weakly_canonical( path, ec );
+		const fs::path resolvedPath = ec ? path : canonical;
+		return std::any_of( tempDirs.begin(), tempDirs.end(), [ &resolvedPath ] ( const fs::path& tempDir )
+		{
+			std::error_code tempError;
+			const fs::path resolvedTemp = fs::weakly_canonical( tempDir, tempError );
+			const fs::path relative = resolvedPath.lexically_relative( tempError ? tempDir : resolvedTemp );
+			return !tempDir.empty() && !relative.empty() && *relative.begin() != "..";
+		} );
+	}
 
-	inline std::string pathToString( const fs::path& path )
+	void countError( common::ErrorStats& errors, const std::error_code& error )
 	{
-		std::u8string u8str = path.u8string();
-		return std::string( reinterpret_cast< const char* >( u8str.c_str() ) );
+		if ( error == std::errc::permission_denied || error == std::errc::operation_not_permitted )
+		{
+			++errors.denied;
+		}
+		else if ( core::OpenFileIndex::isBusyError( error ) )
+		{
+			++errors.busy;
+		}
+		else if ( error == std::errc::no_such_file_or_directory )
+		{
+			++errors.missing;
+		}
+		else
+		{
+			++errors.other;
+		}
 	}
 }
 
+core::SystemCleaner::SystemCleaner() : m_runLog( RUN_LOG_PATH ), m_quarantine( std::make_shared< Quarantine >( QUARANTINE_PATH ) ),
+	m_snapshot( SNAPSHOT_RUNS_DIR )
+{
+}
+
 core::SystemCleaner::~SystemCleaner()
 {
 	fini();
@@ -41,73 +123,310 @@ common::Summary core::SystemCleaner::getSummary()
 	return m_summary;
 }
 
-void core::SystemCleaner::clear( const common::CleaningItems& cleanTargets )
+core::ScanDiff core::SystemCleaner::getScanDiff()
 {
-	using clock = std::chrono::steady_clock;
-	const auto startTime = clock::now();
+	std::scoped_lock lock( m_summaryMutex );
+	return m_scanDiff;
+}
 
-	analysisTargets( cleanTargets );
+core::Task< common::Summary > core::SystemCleaner::analysisAsync( common::CleaningItems cleanTargets, RunOptions options )
+{
+	claimIdle();
+	m_onProgress.store( options.onProgress ? std::make_shared< const ProgressCallback >( std::move( options.onProgress ) ) : nullptr );
+	const TaskHandle run = startAnalysis( cleanTargets );
+	scheduleTimeout( options.timeout );
+
+	co_await run;
+	m_onProgress.store( nullptr );
+	co_return getSummary();
+}
 
-	m_cleanedFiles = 0;
+core::Task< common::Summary > core::SystemCleaner::clearAsync( common::CleaningItems cleanTargets, RunOptions options )
+{
+	claimIdle();
+	m_onProgress.store( options.onProgress ? std::make_shared< const ProgressCallback >( std::move( options.onProgress ) ) : nullptr );
+	const TaskHandle run = startClear( cleanTargets, options.clearMode );
+	scheduleTimeout( options.timeout );
+
+	co_await run;
+	m_onProgress.store( nullptr );
+	co_return getSummary();
+}
+
+void core::SystemCleaner::claimIdle()
+{
+	// the summary, progress and cancel token belong to one run at a time
+	common::CleanerState state = common::CleanerState::IDLE;
+	if ( !m_currentState.compare_exchange_strong( state, common::CleanerState::ANALYZING ) )
+	{
+		throw std::logic_error( "another run has not finished or its summary was not taken" );
+	}
+}
+
+void core::SystemCleaner::cancel()
+{
+	*m_cancelToken = true;
+}
+
+bool core::SystemCleaner::canUndoClear() const
+{
+	return !m_quarantine->isEmpty();
+}
+
+void core::SystemCleaner::undoClear()
+{
+	// merging a tree back can take long, the ui thread only starts it
+	m_backgroundJobs.run( [ this ] ()
+	{
+		const size_t restored = m_quarantine->restore();
+		{
+			std::scoped_lock lock( m_summaryMutex );
+			m_restoredCount = restored;
+		}
+		notifyChanged();
+	} );
+}
+
+std::optional< size_t > core::SystemCleaner::takeRestoredCount()
+{
+	std::scoped_lock lock( m_summaryMutex );
+	return std::exchange( m_restoredCount, std::nullopt );
+}
+
+void core::SystemCleaner::setReport( std::optional< ReportSettings > settings )
+{
+	m_reportSettings = std::move( settings );
+}
+
+void core::SystemCleaner::setMetricsFile( std::optional< fs::path > path )
+{
+	m_metrics.setPath( std::move( path ) );
+}
+
+core::TaskHandle core::SystemCleaner::clear( const common::CleaningItems& cleanTargets, ClearMode mode )
+{
+	claimIdle();
+	return startClear( cleanTargets, mode );
+}
+
+core::TaskHandle core::SystemCleaner::startClear( const common::CleaningItems& cleanTargets, ClearMode mode )
+{
+	using clock = std::chrono::steady_clock;
+	const auto startTime = clock::now();
+	beginRun();
+	openReport();
 
-	TaskManager::instance().addTask( [ this, startTime, cleanTargets ] ()
+	// cleaning runs in the background, interactive analysis goes ahead of it
+	return TaskManager::instance().addTask( [ this, startTime, cleanTargets, mode ] ()
 	{
 		// Awaiting analysis
-		while ( TaskManager::instance().countActiveTasks() > 1 )
 		{
-			m_progress = ( float ) TaskManager::instance().countActiveTasks() / ( float ) m_countAnalysTasks;
+			TaskGroup analysisGroup( TaskPriority::LOW );
+			IoScheduler scheduler( analysisGroup );
+			analysisTargets( cleanTargets, scheduler );
+			analysisGroup.wait();
+
+			std::scoped_lock lock( m_summaryMutex );
+			if ( !*m_cancelToken )
+			{
+				m_metrics.recordFound( m_summary );
+			}
 		}
-		
+
 		// Start cleaning
 		const uint64_t totalFiles = m_summary.totalFiles;
-		if ( totalFiles != 0 )
+		if ( totalFiles != 0 && !*m_cancelToken )
 		{
-			clearTargets( cleanTargets );
-			while ( TaskManager::instance().countActiveTasks() > 1 )
+			m_filesToClean = totalFiles;
+			// the bar only moves forward, cleaning counts its own files from the start again
+			m_progress = 0.f;
+			// a quarantined option's files move together, so open files are looked up by folder too
+			m_openFileIndex = OpenFileIndex::build( mode == ClearMode::QUARANTINE );
 			{
-				m_progress = m_cleanedFiles / totalFiles;
+				TaskGroup cleanGroup( TaskPriority::LOW );
+				IoScheduler scheduler( cleanGroup );
+				clearTargets( cleanTargets, scheduler, mode );
+				cleanGroup.wait();
+
+				std::scoped_lock lock( m_summaryMutex );
+				m_summary.concurrency = scheduler.getStats();
 			}
 
-			m_progress = 1.f;
+			m_openFileIndex = {};
 		}
+		setProgress( 1.f );
 
 		const auto endTime = clock::now();
 		const std::chrono::duration< float > elapsed = endTime - startTime;
 
+		if ( mode == ClearMode::QUARANTINE )
+		{
+			TaskManager::instance().addDelayedTask( [ quarantine = m_quarantine, movedBefore = std::chrono::steady_clock::now() ] ()
+			{
+				quarantine->purge( movedBefore );
+			}, QUARANTINE_PURGE_DELAY, TaskPriority::LOW );
+		}
+
+		saveSnapshot( common::SummaryType::CLEANING );
+		m_report.close();
+		logRun( common::SummaryType::CLEANING, elapsed.count() );
+
 		m_summary.type = common::SummaryType::CLEANING;
 		m_summary.totalTime = elapsed.count();
+		m_summary.isCancelled = *m_cancelToken;
+		exportMetrics();
 
 		m_currentState = common::CleanerState::CLEANING_DONE;
+		notifyChanged();
 	} );
 }
 
-void core::SystemCleaner::analysis( const common::CleaningItems& cleanTargets )
+core::TaskHandle core::SystemCleaner::analysis( const common::CleaningItems& cleanTargets )
+{
+	claimIdle();
+	return startAnalysis( cleanTargets );
+}
+
+core::TaskHandle core::SystemCleaner::startAnalysis( const common::CleaningItems& cleanTargets )
 {
 	using clock = std::chrono::steady_clock;
 
 	const auto startTime = clock::now();
-	analysisTargets( cleanTargets );
+	beginRun();
+	openReport();
 
-	TaskManager::instance().addTask( [ this, startTime ] ()
+	return TaskManager::instance().addTask( [ this, startTime, cleanTargets ] ()
 	{
-		while ( TaskManager::instance().countActiveTasks() > 1 )
 		{
-			m_progress = ( float ) TaskManager::instance().countActiveTasks() / ( float ) m_countAnalysTasks;
+			TaskGroup analysisGroup( TaskPriority::HIGH );
+			IoScheduler scheduler( analysisGroup );
+			analysisTargets( cleanTargets, scheduler );
+			analysisGroup.wait();
+
+			std::scoped_lock lock( m_summaryMutex );
+			m_summary.concurrency = scheduler.getStats();
 		}
 
 		const auto endTime = clock::now();
 		const std::chrono::duration< float > elapsed = endTime - startTime;
 		const float duration = elapsed.count();
 
-		m_progress = 1.f;
+		saveSnapshot( common::SummaryType::ANALYSIS );
+		m_report.close();
+		logRun( common::SummaryType::ANALYSIS, duration );
+
+		setProgress( 1.f );
 
 		m_summary.type = common::SummaryType::ANALYSIS;
 		m_summary.totalTime = duration < EPS ? 0.0f : duration;
+		m_summary.isCancelled = *m_cancelToken;
+		exportMetrics();
 
 		m_currentState = common::CleanerState::ANALYSIS_DONE;
+		notifyChanged();
 	} );
 }
 
+core::TaskHandle core::SystemCleaner::findDuplicates( const common::CleaningItems& cleanTargets )
+{
+	using clock = std::chrono::steady_clock;
+
+	claimIdle();
+	const auto startTime = clock::now();
+	beginRun();
+	resetData();
+
+	std::vector< OptionTarget > targets;
+	for ( const common::CleaningItem& cleaningItem : cleanTargets )
+	{
+		const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
+		for ( const common::CleanOption& cleanOption : cleaningItem.cleanOptions )
+		{
+			if ( cleanOption.enabled && cleanOption.displayName != RECYCLE_BIN )
+			{
+				targets.push_back( getOptionTarget( cleanOption.id, isCustomItem ) );
+			}
+		}
+	}
+
+	return TaskManager::instance().addTask( [ this, startTime, targets = std::move( targets ) ] ()
+	{
+		const std::shared_ptr< std::atomic< bool > > cancelToken = m_cancelToken;
+
+		// files are listed by the same walk as an analysis, with its device limits, protection checks and rules
+		std::vector< DuplicateCandidate > files;
+		{
+			std::mutex filesMutex;
+			TaskGroup collectGroup( TaskPriority::HIGH );
+			IoScheduler scheduler( collectGroup );
+			std::vector< IoWork > works;
+			for ( const OptionTarget& target : targets )
+			{
+				works.push_back( { target.path, [ this, &target, &files, &filesMutex, &cancelToken ] ()
+				{
+					if ( *cancelToken )
+					{
+						return;
+					}
+
+					std::vector< DuplicateCandidate > found;
+					(void)processPath( target.path, false, nullptr, nullptr, target.rules.get(), true, &found );
+
+					std::scoped_lock lock( filesMutex );
+					files.insert( files.end(), std::make_move_iterator( found.begin() ), std::make_move_iterator( found.end() ) );
+				} } );
+			}
+			scheduler.schedule( std::move( works ) );
+			collectGroup.wait();
+		}
+
+		const std::vector< DuplicateGroup > duplicates = core::findDuplicates( std::move( files ), *cancelToken, [ this ] ( float progress )
+		{
+			setProgress( progress );
+		} );
+
+		const auto endTime = clock::now();
+		const std::chrono::duration< float > elapsed = endTime - startTime;
+		{
+			std::scoped_lock lock( m_summaryMutex );
+			for ( const DuplicateGroup& duplicate : duplicates )
+			{
+				m_summary.totalFiles += duplicate.paths.size() - 1;
+				m_summary.totalSize += duplicate.reclaimableSize();
+				if ( m_summary.results.size() == MAX_DUPLICATE_RESULTS )
+				{
+					continue;
+				}
+
+				// one row per group, the copies beyond the first are what can be reclaimed
+				common::CleanResult result {
+					.propertyName = utils::pathToString( duplicate.paths.front().filename() ),
+					.categoryName = std::to_string( duplicate.paths.size() ) + " copies",
+					.cleanedFiles = duplicate.paths.size() - 1,
+					.cleanedSize = duplicate.reclaimableSize(),
+					.paths = {} };
+				for ( const fs::path& path : duplicate.paths )
+				{
+					result.paths.push_back( utils::pathToString( path ) );
+				}
+				m_summary.results.push_back( std::move( result ) );
+			}
+
+			m_summary.type = common::SummaryType::DUPLICATES;
+			m_summary.isCancelled = *cancelToken;
+			m_summary.totalTime = elapsed.count() < EPS ? 0.0f : elapsed.count();
+		}
+
+		m_currentState = common::CleanerState::ANALYSIS_DONE;
+		notifyChanged();
+	}, TaskPriority::HIGH );
+}
+
+std::vector< core::OptionTrend > core::SystemCleaner::getTrends( uint64_t thresholdBytes ) const
+{
+	return m_runLog.queryTrends( thresholdBytes );
+}
+
 common::CleanerState core::SystemCleaner::getCurrentState()
 {
 	return m_currentState;
@@ -118,17 +437,51 @@ float core::SystemCleaner::getCurrentProgress()
 	return m_progress;
 }
 
-common::CleaningItems core::SystemCleaner::collectCleaningItems()
+void core::SystemCleaner::setChangeListener( std::function< void() > listener )
 {
-	common::CleaningItems cleaningItems;
-	initBrowserData( cleaningItems );
-	initSystemTempData( cleaningItems );
+	m_changeListener = std::move( listener );
+}
 
-	initCustomPaths( cleaningItems );
+common::CleaningItems core::SystemCleaner::collectCleaningItems()
+{
+	// every section may touch slow profiles or network homes, the window is shown without waiting for them
+	m_startupJobs.run( [ this ] ()
+	{
+		initSystemTempData();
+	} );
+	m_startupJobs.run( [ this ] ()
+	{
+		initBrowserData();
+	} );
+	m_startupJobs.run( [ this ] ()
+	{
+		initCustomPaths();
+	} );
+	// trees a previous session moved aside are not needed for anything
+	TaskManager::instance().addTask( [ quarantine = m_quarantine, movedBefore = std::chrono::steady_clock::now() ] ()
+	{
+		quarantine->purge( movedBefore );
+	}, TaskPriority::LOW );
+	m_startupJobs.run( [ this ] ()
+	{
+		{
+			std::scoped_lock lock( m_targetsWatch->mutex );
+			m_targetsWatch->lastWriteTime = getWriteTime( TARGETS_PATH );
+		}
+		loadTargets();
+		watchTargets();
+	} );
 
+	common::CleaningItems cleaningItems;
+	cleaningItems.emplace_back( "Custom paths", common::ItemType::CUSTOM_PATH );
 	return cleaningItems;
 }
 
+bool core::SystemCleaner::isStartupDone() const
+{
+	return m_startupJobs.isDone();
+}
+
 common::PathAdditionResult core::SystemCleaner::addCustomPath( const fs::path& path )
 {
 	if ( common::OptionalString error = utils::path::validate( path ) )
@@ -136,131 +489,100 @@ common::PathAdditionResult core::SystemCleaner::addCustomPath( const fs::path& p
 		return common::PathAdditionResult::error( std::move( *error ) );
 	}
 
-	for ( const auto& customPath : m_customPathCache | std::ranges::views::values )
+	std::scoped_lock lock( m_customPathMutex );
+	return insertCustomPath( path, CustomPathIndex::makeKey( path ) );
+}
+
+void core::SystemCleaner::importCustomPaths( std::vector< std::string > sources, bool isRestore )
+{
+	m_backgroundJobs.run( [ this, sources = std::move( sources ), isRestore ] ()
 	{
-		try
+		runImport( sources, isRestore );
+	} );
+}
+
+void core::SystemCleaner::importCustomPathList( const fs::path& listFile )
+{
+	m_backgroundJobs.run( [ this, listFile ] ()
+	{
+		std::vector< std::string > sources;
+		if ( std::ifstream input( listFile ); input )
 		{
-			if ( fs::equivalent( path, customPath ) )
+			for ( std::string line; std::getline( input, line ); )
 			{
-				return common::PathAdditionResult::error( "Duplicated path" );
+				const size_t first = line.find_first_not_of( " \t\r\"" );
+				const size_t last = line.find_last_not_of( " \t\r\"" );
+				if ( first != std::string::npos && line[ first ] != '#' )
+				{
+					sources.push_back( line.substr( first, last - first + 1 ) );
+				}
 			}
 		}
-		catch ( const std::exception& ) {}
-	}
+		runImport( sources, false );
+	} );
+}
 
-	common::CleanOption option { .displayName = pathToString( path.filename().string() ) };
-	m_customPathCache[ option.id ] = path;
+common::DiscoveredItems core::SystemCleaner::takeDiscoveredItems()
+{
+	std::scoped_lock lock( m_cleanPathMutex );
+	return std::exchange( m_discoveredItems, {} );
+}
 
-	return common::PathAdditionResult::success( std::move( option ) );
+std::vector< common::ImportResult > core::SystemCleaner::takeImportResults()
+{
+	std::scoped_lock lock( m_customPathMutex );
+	return std::exchange( m_importResults, {} );
 }
 
 void core::SystemCleaner::removeCustomPath( uint64_t id )
 {
+	std::scoped_lock lock( m_customPathMutex );
 	m_customPathCache.erase( id );
+	m_customPathIndex.erase( id );
 }
 
 common::OptionalString core::SystemCleaner::getFullPath( uint64_t id )
 {
-	if ( m_customPathCache.contains( id ) )
+	std::scoped_lock lock( m_customPathMutex );
+	if ( auto it = m_customPathCache.find( id ); it != m_customPathCache.end() )
 	{
-		return pathToString( m_customPathCache[ id ].string() );
+		return utils::pathToString( it->second.string() );
 	}
 
 	return std::nullopt;
 }
 
-void core::SystemCleaner::initBrowserData( common::CleaningItems& cleaningItems )
+void core::SystemCleaner::initBrowserData()
 {
-	const fs::path local = utils::FileSystem::instance().getLocalAppDataDir();
-	const fs::path roaming = utils::FileSystem::instance().getRoamingAppDataDir();
-
-	auto isBrowserInstalled = [ & ] ( std::string_view folderName )
-	{
-		return fs::exists( local / folderName ) || fs::exists( roaming / folderName );
-	};
-
-	auto addBrowserInfo = [ this, &cleaningItems ] ( std::string_view browserName,
-									 const fs::path& basePath,
-									 std::string_view cachePath = CACHE,
-									 std::string_view cookiesPath = "Network\\Cookies",
-									 std::string_view historyPath = HISTORY )
+	common::CleaningItems browserItems;
+	const std::vector< DiscoveredBrowser > browsers = discoverBrowsers();
 	{
-		common::CleaningItem item( browserName.data(), common::ItemType::BROWSER );
-		std::vector< std::pair< std::string_view, fs::path > > options =
-		{
-			{ CACHE, basePath / cachePath },
-			{ "Cookies", basePath / cookiesPath},
-			{ HISTORY, basePath / historyPath }
-		};
-
-		for ( const auto& [ displayName, fullPath ] : options )
+		std::scoped_lock lock( m_cleanPathMutex );
+		for ( const DiscoveredBrowser& browser : browsers )
 		{
-			if ( fs::exists( fullPath ) )
+			common::CleaningItem item( browser.name, common::ItemType::BROWSER );
+			for ( const BrowserOption& browserOption : browser.options )
 			{
-				common::CleanOption option { .displayName = displayName.data() };
-				m_cleanPathCache[ option.id ] = fullPath;
+				common::CleanOption option { .displayName = browserOption.displayName };
+				m_cleanPathCache[ option.id ] = browserOption.path;
 				item.cleanOptions.push_back( std::move( option ) );
 			}
+			browserItems.push_back( std::move( item ) );
 		}
-
-		if ( !item.cleanOptions.empty() )
-		{
-			cleaningItems.push_back( std::move( item ) );
-		}
-	};
-
-	if ( isBrowserInstalled( common::GOOGLE_CHROME_PATH ) )
-	{
-		const fs::path base = local / common::GOOGLE_CHROME_PATH / common::USER_DATA_DEFAULT;
-		addBrowserInfo( common::GOOGLE_CHROME, base );
-	}
-
-	if ( isBrowserInstalled( common::MOZILLA_FIREFOX_PATH ) )
-	{
-		const fs::path profilesRoot = roaming / common::MOZILLA_FIREFOX_PATH / "Profiles";
-		if ( fs::exists( profilesRoot ) )
-		{
-			for ( auto& entry : fs::directory_iterator( profilesRoot ) )
-			{
-				if ( !entry.is_directory() )
-				{
-					continue;
-				}
-				
-				const fs::path profilePath = entry.path();
-				addBrowserInfo( common::MOZILLA_FIREFOX, profilePath, 
-								"cache2\\entries", "cookies.sqlite", "places.sqlite" );
-			}
-		}
-	}
-
-	if ( isBrowserInstalled( common::YANDEX_BROWSER_PATH ) )
-	{
-		const fs::path base = local / common::YANDEX_BROWSER_PATH / common::USER_DATA_DEFAULT;
-		addBrowserInfo( common::YANDEX_BROWSER, base );
-	}
-
-	if ( isBrowserInstalled( common::MICROSOFT_EDGE_PATH ) )
-	{
-		const fs::path base = local / common::MICROSOFT_EDGE_PATH / common::USER_DATA_DEFAULT;
-		addBrowserInfo( common::MICROSOFT_EDGE, base );
-	}
-
-	if ( isBrowserInstalled( common::OPERA_PATH ) )
-	{
-		const fs::path base = roaming / common::OPERA_PATH;
-		addBrowserInfo( common::OPERA, base );
 	}
+	addDiscoveredItems( std::move( browserItems ) );
 }
 
-void core::SystemCleaner::initSystemTempData( common::CleaningItems& cleaningItems )
+void core::SystemCleaner::initSystemTempData()
 {
 	auto& fs = utils::FileSystem::instance();
 
+	common::CleaningItems cleaningItems;
 	const auto addCleaningItem = [ & ] ( std::string name, common::ItemType type, 
 		const std::vector< std::pair< std::string_view, fs::path > >& options )
 	{
 		common::CleaningItem item( name, type );
+		std::scoped_lock lock( m_cleanPathMutex );
 		for ( const auto& [ displayName, fullPath ] : options )
 		{
 			common::CleanOption option { .displayName = displayName.data() };
@@ -282,18 +604,21 @@ void core::SystemCleaner::initSystemTempData( common::CleaningItems& cleaningIte
 		{ "Prefetch", fs.getPrefetchDir() },
 		{ RECYCLE_BIN, "" }
 	} );
+
+	// temp and system share a tab, they arrive together
+	addDiscoveredItems( std::move( cleaningItems ) );
 }
 
-void core::SystemCleaner::initCustomPaths( common::CleaningItems& cleaningItems )
+void core::SystemCleaner::initCustomPaths()
 {
-	common::CleaningItem customItem( "Custom paths", common::ItemType::CUSTOM_PATH );
-	
+	// saved paths are validated here and arrive through takeImportResults
+	std::vector< std::string > savedPaths;
 	if ( std::ifstream input( SAVING_PATH, std::ios::binary ); input )
 	{
 		uint32_t size = 0;
 		while ( input.read( reinterpret_cast< char* > ( &size ), sizeof( size ) ) )
 		{
-			if ( size == 0 || size > 10000 )
+			if ( size == 0 || size > MAX_SAVED_PATH_SIZE )
 			{
 				break;
 			}
@@ -304,185 +629,758 @@ void core::SystemCleaner::initCustomPaths( common::CleaningItems& cleaningItems
 				break;
 			}
 
-			common::PathAdditionResult result = addCustomPath( std::move( strPath ) );
-			if ( result.isSuccess() )
-			{
-				customItem.cleanOptions.push_back( std::move( result.option ) );
-			}			
-		}
-	}
-
-	cleaningItems.push_back( customItem );
-}
-
-void core::SystemCleaner::fini()
-{
-	if ( m_customPathCache.empty() )
-	{
-		if ( fs::exists( SAVING_PATH ) )
-		{
-			fs::remove( SAVING_PATH );
+			savedPaths.push_back( std::move( strPath ) );
 		}
-		return;
 	}
 
-	fs::create_directories( CONFIG_DIR );
-
-	std::ofstream output( SAVING_PATH, std::ios::binary );
-	for ( const auto& customPath : m_customPathCache | std::ranges::views::values )
+	if ( !savedPaths.empty() )
 	{
-		std::string pathStr = customPath.string();
-		const uint32_t size = static_cast< uint32_t >( pathStr.size() );
-
-		output.write( reinterpret_cast< const char* > ( &size ), sizeof( size ) );
-		output.write( pathStr.c_str(), size );
+		runImport( savedPaths, true );
 	}
 }
 
-void core::SystemCleaner::analysisTargets( const common::CleaningItems& cleaningItems )
+void core::SystemCleaner::addDiscoveredItems( common::CleaningItems items )
 {
-	resetData();
-	m_currentState = common::CleanerState::ANALYZING;
-
-	for ( const common::CleaningItem& cleaningItem : cleaningItems )
 	{
-		if ( !cleaningItem.isNeedClean() )
-		{
-			continue;
-		}
-		++m_countAnalysTasks;
-		
-		TaskManager::instance().addTask( [ this, cleaningItem ] ()
-		{
-			analysisOptions( cleaningItem );
-		} );
+		std::scoped_lock lock( m_cleanPathMutex );
+		m_discoveredItems.items.insert( m_discoveredItems.items.end(), std::make_move_iterator( items.begin() ), std::make_move_iterator( items.end() ) );
 	}
+	notifyChanged();
 }
 
-core::DirInfo core::SystemCleaner::processPath( const fs::path& pathDir, bool deleteFiles )
+void core::SystemCleaner::loadTargets()
 {
-	core::DirInfo info {};
+	TargetConfig config = loadTargetConfig( TARGETS_PATH );
 
-	auto processFile = [ &info, deleteFiles ] ( const fs::path& filePath, uint64_t fileSize )
+	common::CleaningItems items;
 	{
-		try
+		std::scoped_lock lock( m_cleanPathMutex );
+		for ( const uint64_t id : m_targetOptionIds )
 		{
-			bool shouldCount = !deleteFiles || fs::remove( filePath );
-			if ( shouldCount )
-			{
-				++info.countFile;
-				info.dirSize += fileSize;
-			}
+			m_cleanPathCache.erase( id );
+			m_optionRules.erase( id );
 		}
-		catch ( const fs::filesystem_error& ) {}
-	};
+		m_targetOptionIds.clear();
 
-	try
-	{
-		if ( fs::is_directory( pathDir ) )
+		for ( TargetDefinition& target : config.targets )
 		{
-			for ( const auto& entry : fs::recursive_directory_iterator( pathDir, fs::directory_options::skip_permission_denied ) )
+			common::CleaningItem item( std::move( target.name ), target.itemType );
+			item.isConfigured = true;
+			for ( TargetOption& targetOption : target.options )
 			{
-				if ( entry.is_regular_file() )
+				// the recycle bin is recognized by its name, a configured option must not empty it
+				if ( targetOption.displayName == RECYCLE_BIN )
+				{
+					config.errors.push_back( item.name + ": " + std::string( RECYCLE_BIN ) + " is a reserved name" );
+					continue;
+				}
+
+				common::CleanOption option { .displayName = std::move( targetOption.displayName ) };
+				m_cleanPathCache[ option.id ] = std::move( targetOption.path );
+				if ( targetOption.rules )
 				{
-					processFile( entry.path(), entry.file_size() );
+					m_optionRules[ option.id ] = std::move( targetOption.rules );
 				}
+				m_targetOptionIds.push_back( option.id );
+				item.cleanOptions.push_back( std::move( option ) );
+			}
+
+			if ( !item.cleanOptions.empty() )
+			{
+				items.push_back( std::move( item ) );
 			}
 		}
-		else if ( fs::is_regular_file( pathDir ) )
+
+		// configured items nobody has taken yet belong to the previous load
+		std::erase_if( m_discoveredItems.items, [] ( const common::CleaningItem& item )
 		{
-			processFile( pathDir, fs::file_size( pathDir ) );
-		}
+			return item.isConfigured;
+		} );
+		m_discoveredItems.items.insert( m_discoveredItems.items.end(), std::make_move_iterator( items.begin() ), std::make_move_iterator( items.end() ) );
+		m_discoveredItems.isTargetsReload = true;
+		m_discoveredItems.targetErrors = std::move( config.errors );
 	}
-	catch ( const fs::filesystem_error& ) {}
-
-	return info;
+	notifyChanged();
 }
 
-void core::SystemCleaner::analysisOptions( const common::CleaningItem& cleaningItem )
+void core::SystemCleaner::watchTargets()
 {
-	const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
-	for ( const common::CleanOption& cleanOption : cleaningItem.cleanOptions )
+	// a write time poll is all it takes, editors replace the file as often as they write it in place
+	TaskManager::instance().addDelayedTask( [ this, watch = m_targetsWatch ] ()
 	{
-		if ( !cleanOption.enabled )
+		std::scoped_lock lock( watch->mutex );
+		if ( !watch->isActive )
 		{
-			continue;
+			return;
 		}
 
-		if ( cleanOption.displayName == RECYCLE_BIN )
+		const std::optional< fs::file_time_type > writeTime = getWriteTime( TARGETS_PATH );
+		if ( writeTime != watch->lastWriteTime )
 		{
-			core::DirInfo dirInfo {};
+			watch->lastWriteTime = writeTime;
+			loadTargets();
+		}
+		watchTargets();
+	}, TARGETS_POLL_INTERVAL, TaskPriority::LOW );
+}
 
-			SHQUERYRBINFO rbInfo {};
-			rbInfo.cbSize = sizeof( SHQUERYRBINFO );
+void core::SystemCleaner::runImport( const std::vector< std::string >& sources, bool isRestore )
+{
+	TaskManager& taskManager = TaskManager::instance();
 
-			const HRESULT hr = SHQueryRecycleBinA( nullptr, &rbInfo );
-			if ( SUCCEEDED( hr ) )
+	std::vector< std::vector< fs::path > > expanded( sources.size() );
+	taskManager.parallelFor( sources.size(), [ & ] ( size_t i )
+	{
+		expanded[ i ] = utils::glob::expand( fs::path( sources[ i ] ) );
+		if ( expanded[ i ].empty() )
+		{
+			// keep the entry, so it is reported as not found
+			expanded[ i ].push_back( fs::path( sources[ i ] ) );
+		}
+	} );
+
+	std::vector< fs::path > paths;
+	for ( std::vector< fs::path >& sourcePaths : expanded )
+	{
+		paths.insert( paths.end(), std::make_move_iterator( sourcePaths.begin() ), std::make_move_iterator( sourcePaths.end() ) );
+	}
+
+	// validation and identity lookups are the expensive part and need no lock
+	std::vector< common::OptionalString > errors( paths.size() );
+	std::vector< CustomPathIndex::Key > keys( paths.size() );
+	taskManager.parallelFor( paths.size(), [ & ] ( size_t i )
+	{
+		errors[ i ] = utils::path::validate( paths[ i ] );
+		if ( !errors[ i ] )
+		{
+			keys[ i ] = CustomPathIndex::makeKey( paths[ i ] );
+		}
+	} );
+
+	common::ImportResult importResult { .isRestore = isRestore, .entries = {} };
+	importResult.entries.reserve( paths.size() );
+	{
+		std::scoped_lock lock( m_customPathMutex );
+		for ( size_t i = 0; i < paths.size(); ++i )
+		{
+			common::PathAdditionResult result = errors[ i ] ?
+				common::PathAdditionResult::error( std::move( *errors[ i ] ) ) :
+				insertCustomPath( paths[ i ], std::move( keys[ i ] ) );
+			importResult.entries.push_back( { utils::pathToString( paths[ i ] ), std::move( result ) } );
+		}
+		m_importResults.push_back( std::move( importResult ) );
+	}
+	notifyChanged();
+}
+
+common::PathAdditionResult core::SystemCleaner::insertCustomPath( const fs::path& path, CustomPathIndex::Key key )
+{
+	if ( common::OptionalString conflict = m_customPathIndex.findConflict( key ) )
+	{
+		return common::PathAdditionResult::error( std::move( *conflict ) );
+	}
+
+	common::CleanOption option { .displayName = utils::pathToString( path.filename().string() ) };
+	m_customPathCache[ option.id ] = path;
+	m_customPathIndex.insert( option.id, std::move( key ) );
+
+	return common::PathAdditionResult::success( std::move( option ) );
+}
+
+fs::path core::SystemCleaner::getOptionPath( uint64_t id, bool isCustom )
+{
+	std::scoped_lock lock( isCustom ? m_customPathMutex : m_cleanPathMutex );
+	const std::unordered_map< uint64_t, fs::path >& pathCache = isCustom ? m_customPathCache : m_cleanPathCache;
+	auto it = pathCache.find( id );
+	return it != pathCache.end() ? it->second : fs::path();
+}
+
+core::SystemCleaner::OptionTarget core::SystemCleaner::getOptionTarget( uint64_t id, bool isCustom )
+{
+	// custom paths have no rules
+	if ( isCustom )
+	{
+		return { getOptionPath( id, true ), nullptr };
+	}
+
+	std::scoped_lock lock( m_cleanPathMutex );
+	OptionTarget target;
+	if ( auto it = m_cleanPathCache.find( id ); it != m_cleanPathCache.end() )
+	{
+		target.path = it->second;
+	}
+	if ( auto it = m_optionRules.find( id ); it != m_optionRules.end() )
+	{
+		target.rules = it->second;
+	}
+	return target;
+}
+
+void core::SystemCleaner::fini()
+{
+	{
+		// waits for a reload in progress, the next poll finds the watch inactive
+		std::scoped_lock lock( m_targetsWatch->mutex );
+		m_targetsWatch->isActive = false;
+	}
+	// moved trees not purged yet stay listed for the next session
+	m_quarantine->stop();
+
+	// a pending import may still add paths that must be saved
+	m_startupJobs.wait();
+	m_backgroundJobs.wait();
+
+	if ( m_customPathCache.empty() )
+	{
+		if ( fs::exists( SAVING_PATH ) )
+		{
+			fs::remove( SAVING_PATH );
+		}
+		return;
+	}
+
+	fs::create_directories( CONFIG_DIR );
+
+	std::ofstream output( SAVING_PATH, std::ios::binary );
+	for ( const auto& customPath : m_customPathCache | std::ranges::views::values )
+	{
+		std::string pathStr = customPath.string();
+		const uint32_t size = static_cast< uint32_t >( pathStr.size() );
+
+		output.write( reinterpret_cast< const char* > ( &size ), sizeof( size ) );
+		output.write( pathStr.c_str(), size );
+	}
+}
+
+void core::SystemCleaner::analysisTargets( const common::CleaningItems& cleaningItems, IoScheduler& scheduler )
+{
+	resetData();
+	{
+		std::scoped_lock lock( m_summaryMutex );
+		m_analysedOptions.clear();
+	}
+	m_currentState = common::CleanerState::ANALYZING;
+	m_reportRun = REPORT_ANALYSIS;
+
+	std::vector< IoWork > works;
+	for ( const common::CleaningItem& cleaningItem : cleaningItems )
+	{
+		const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
+		for ( const common::CleanOption& cleanOption : cleaningItem.cleanOptions )
+		{
+			if ( !cleanOption.enabled )
 			{
-				dirInfo.countFile = static_cast< uint64_t >( rbInfo.i64NumItems );
-				dirInfo.dirSize = static_cast< uint64_t >( rbInfo.i64Size );
+				continue;
 			}
 
-			accumulateResult( common::SYSTEM, cleanOption.displayName, dirInfo );
-			continue;
+			OptionTarget target = getOptionTarget( cleanOption.id, isCustomItem );
+			fs::path root = target.path;
+			works.push_back( { std::move( root ), [ this, &cleaningItem, &cleanOption, target = std::move( target ) ] ()
+			{
+				if ( !*m_cancelToken )
+				{
+					analysisOption( cleaningItem, cleanOption, target.path, target.rules.get() );
+				}
+				setProgress( static_cast< float >( ++m_countDoneTasks ) / static_cast< float >( m_countAnalysTasks ) );
+			} } );
+		}
+	}
+
+	// the total is known before the first task can finish and report progress
+	m_countAnalysTasks = works.size();
+	scheduler.schedule( std::move( works ) );
+}
+
+core::DirInfo core::SystemCleaner::processPath( const fs::path& pathDir, bool deleteFiles, DirRecords* records, const ReportRow* reportScope,
+	const TargetRules* rules, bool isFileProgress, std::vector< DuplicateCandidate >* foundFiles )
+{
+	// what one walk found or removed, the subfolders of the path are walked in parallel into their own state
+	struct WalkState
+	{
+		core::DirInfo info;
+		// files found by analysis or left after cleaning, grouped by parent directory
+		std::unordered_map< std::string, core::DirInfo > remainingByDir;
+		// files found or removed for a detailed report, directory rows are written once the walk is done
+		std::unordered_map< std::string, core::DirInfo > reportedByDir;
+		std::vector< core::DuplicateCandidate > foundFiles;
+	};
+
+	auto recordFile = [ records ] ( WalkState& state, const fs::path& filePath, uint64_t fileSize )
+	{
+		if ( records )
+		{
+			core::DirInfo& dirInfo = state.remainingByDir[ utils::pathToString( filePath.parent_path() ) ];
+			++dirInfo.countFile;
+			dirInfo.dirSize += fileSize;
+		}
+	};
+
+	const bool isFileReport = reportScope && m_report.wants( ReportDetail::FILES );
+	const bool isDirReport = reportScope && m_report.wants( ReportDetail::DIRECTORIES );
+	auto reportFile = [ this, reportScope, isFileReport, isDirReport ] ( WalkState& state, const fs::path& filePath, uint64_t fileSize )
+	{
+		if ( isDirReport )
+		{
+			core::DirInfo& dirInfo = state.reportedByDir[ utils::pathToString( filePath.parent_path() ) ];
+			++dirInfo.countFile;
+			dirInfo.dirSize += fileSize;
+		}
+
+		if ( isFileReport )
+		{
+			const std::string path = utils::pathToString( filePath );
+			ReportRow row = *reportScope;
+			row.level = REPORT_FILE;
+			row.path = path;
+			row.files = 1;
+			row.bytes = fileSize;
+			m_report.write( row );
+		}
+	};
+
+	auto processFile = [ this, &recordFile, &reportFile, deleteFiles, isFileProgress, foundFiles ] ( WalkState& state, const fs::path& filePath, uint64_t fileSize,
+		const utils::FileId* fileId ) -> bool
+	{
+		recordIoOperations();
+		if ( foundFiles && !deleteFiles )
+		{
+			state.foundFiles.push_back( { .path = filePath, .fileSize = fileSize } );
+		}
+
+		bool removed = false;
+		bool pinned = false;
+		try
+		{
+			// unlinking an open file frees nothing until it is closed, so it is not touched
+			pinned = deleteFiles && fileId && m_openFileIndex.contains( *fileId );
+			removed = deleteFiles && !pinned && fs::remove( filePath );
+			if ( !deleteFiles || removed )
+			{
+				++state.info.countFile;
+				state.info.dirSize += fileSize;
+				reportFile( state, filePath, fileSize );
+			}
+
+			if ( removed && isFileProgress )
+			{
+				setProgress( static_cast< float >( ++m_cleanedFiles ) / static_cast< float >( m_filesToClean ) );
+			}
+		}
+		catch ( const fs::filesystem_error& error )
+		{
+			pinned = OpenFileIndex::isBusyError( error.code() );
+			countError( state.info.errors, error.code() );
+		}
+
+		if ( pinned )
+		{
+			++state.info.pinnedFiles;
+			state.info.pinnedSize += fileSize;
+		}
+
+		if ( !removed )
+		{
+			recordFile( state, filePath, fileSize );
+		}
+		return removed;
+	};
+
+	// a cleaning pass looks its files up in the open file index, their size and identity then come from one stat
+	const bool isOpenFileLookup = deleteFiles && m_openFileIndex.size() != 0;
+	auto processEntry = [ &processFile, isOpenFileLookup ] ( WalkState& state, const fs::directory_entry& entry ) -> bool
+	{
+		const std::optional< utils::FileInfo > fileInfo = isOpenFileLookup ? utils::getFileInfo( entry.path() ) : std::nullopt;
+		if ( fileInfo )
+		{
+			return processFile( state, entry.path(), fileInfo->size, &fileInfo->id );
+		}
+		return processFile( state, entry.path(), entry.file_size(), nullptr );
+	};
+
+	if ( utils::path::checkProtected( pathDir ) )
+	{
+		return {};
+	}
+
+	const std::shared_ptr< std::atomic< bool > > cancelToken = m_cancelToken;
+	const fs::file_time_type now = rules ? fs::file_time_type::clock::now() : fs::file_time_type();
+	auto isKeptDir = [ deleteFiles ] ( const fs::path& dirPath )
+	{
+		return deleteFiles && std::find( STRUCTURAL_CACHE_DIRS.begin(), STRUCTURAL_CACHE_DIRS.end(),
+			utils::pathToString( dirPath.filename() ) ) != STRUCTURAL_CACHE_DIRS.end();
+	};
+
+	auto isSpecialFile = [] ( const fs::directory_entry& entry )
+	{
+		return !entry.is_symlink() && ( entry.is_socket() || entry.is_fifo() );
+	};
+
+	// walks one subfolder of the path, the folders the pass emptied below it and the subfolder itself are removed after it
+	auto walkSubDir = [ & ] ( const fs::path& dirPath, WalkState& state )
+	{
+		// only a cleaning pass removes folders, an analysis does not build the tree at all.
+		// the folder of each depth currently being walked, entries at depth d belong to dirStack[ d ]
+		std::optional< EmptyDirTracker > tracker;
+		std::vector< size_t > dirStack;
+		if ( deleteFiles )
+		{
+			tracker.emplace();
+			dirStack.push_back( EmptyDirTracker::ROOT );
+		}
+
+		try
+		{
+			fs::recursive_directory_iterator it( dirPath, fs::directory_options::skip_permission_denied );
+			for ( ; it != fs::recursive_directory_iterator() && !*cancelToken; ++it )
+			{
+				const fs::directory_entry& entry = *it;
+				const size_t parent = tracker ? dirStack[ it.depth() ] : EmptyDirTracker::ROOT;
+
+				// links are never followed, but a link into a protected folder is left alone entirely
+				const bool isSymlink = entry.is_symlink();
+				if ( isSymlink && utils::path::checkProtected( entry.path() ) )
+				{
+					if ( tracker )
+					{
+						tracker->addEntry( parent );
+					}
+					continue;
+				}
+
+				if ( !isSymlink && entry.is_directory() )
+				{
+					if ( tracker )
+					{
+						dirStack.resize( it.depth() + 1 );
+						dirStack.push_back( tracker->addDirectory( entry.path(), parent, isKeptDir( entry.path() ) ) );
+					}
+				}
+				else
+				{
+					if ( tracker )
+					{
+						tracker->addEntry( parent );
+					}
+					// only a cleaning pass removes a file, so the tracker is there
+					if ( entry.is_regular_file() && ( !rules || rules->accepts( entry, now ) ) && processEntry( state, entry ) )
+					{
+						tracker->markRemoved( parent );
+					}
+					else if ( isSpecialFile( entry ) )
+					{
+						++state.info.specialFiles;
+					}
+				}
+			}
+		}
+		catch ( const fs::filesystem_error& error )
+		{
+			// the rest of the subfolder is lost with it
+			countError( state.info.errors, error.code() );
+		}
+
+		if ( tracker )
+		{
+			state.info.removedDirs = tracker->prune();
+			std::error_code ec;
+			if ( tracker->isEmptied( EmptyDirTracker::ROOT ) && !isKeptDir( dirPath ) && fs::remove( dirPath, ec ) )
+			{
+				++state.info.removedDirs;
+			}
+		}
+	};
+
+	WalkState state;
+	std::vector< fs::path > subDirs;
+	try
+	{
+		if ( fs::is_directory( pathDir ) )
+		{
+			// the files of the path itself are handled here, it is never removed
+			for ( const fs::directory_entry& entry : fs::directory_iterator( pathDir, fs::directory_options::skip_permission_denied ) )
+			{
+				if ( *cancelToken )
+				{
+					break;
+				}
+
+				const bool isSymlink = entry.is_symlink();
+				if ( isSymlink && utils::path::checkProtected( entry.path() ) )
+				{
+					continue;
+				}
+
+				if ( !isSymlink && entry.is_directory() )
+				{
+					subDirs.push_back( entry.path() );
+				}
+				else if ( entry.is_regular_file() && ( !rules || rules->accepts( entry, now ) ) )
+				{
+					processEntry( state, entry );
+				}
+				else if ( isSpecialFile( entry ) )
+				{
+					++state.info.specialFiles;
+				}
+			}
+		}
+		else if ( fs::is_regular_file( pathDir ) )
+		{
+			processEntry( state, fs::directory_entry( pathDir ) );
+		}
+	}
+	catch ( const fs::filesystem_error& error )
+	{
+		// the rest of the listing is lost with it
+		countError( state.info.errors, error.code() );
+	}
+
+	// each subfolder is a unit of the device queue, so its worker limit decides how many are walked at once
+	std::vector< WalkState > subStates( subDirs.size() );
+	IoScheduler::runBatch( subDirs.size(), [ &walkSubDir, &subDirs, &subStates ] ( size_t i )
+	{
+		walkSubDir( subDirs[ i ], subStates[ i ] );
+	} );
+
+	// every folder belongs to exactly one walk, so the groups never overlap
+	for ( WalkState& subState : subStates )
+	{
+		state.info.add( subState.info );
+		state.remainingByDir.merge( subState.remainingByDir );
+		state.reportedByDir.merge( subState.reportedByDir );
+		state.foundFiles.insert( state.foundFiles.end(), std::make_move_iterator( subState.foundFiles.begin() ),
+			std::make_move_iterator( subState.foundFiles.end() ) );
+	}
+
+	if ( foundFiles )
+	{
+		foundFiles->insert( foundFiles->end(), std::make_move_iterator( state.foundFiles.begin() ), std::make_move_iterator( state.foundFiles.end() ) );
+	}
+
+	if ( records )
+	{
+		records->reserve( records->size() + state.remainingByDir.size() );
+		for ( auto& [ directory, dirInfo ] : state.remainingByDir )
+		{
+			records->push_back( { .option = {}, .directory = directory, .dirSize = dirInfo.dirSize, .countFile = dirInfo.countFile } );
 		}
+	}
 
-		const fs::path& pathDir = isCustomItem ? m_customPathCache[ cleanOption.id ] : m_cleanPathCache[ cleanOption.id ];
-		const core::DirInfo dirInfo = processPath( pathDir );
-		accumulateResult( cleaningItem.name, cleanOption.displayName, dirInfo );
+	for ( const auto& [ directory, dirInfo ] : state.reportedByDir )
+	{
+		ReportRow row = *reportScope;
+		row.level = REPORT_DIRECTORY;
+		row.path = directory;
+		row.files = dirInfo.countFile;
+		row.bytes = dirInfo.dirSize;
+		m_report.write( row );
 	}
+
+	return state.info;
 }
 
-void core::SystemCleaner::clearTargets( const common::CleaningItems& cleaningItems )
+void core::SystemCleaner::analysisOption( const common::CleaningItem& cleaningItem, const common::CleanOption& cleanOption, const fs::path& pathDir,
+	const TargetRules* rules )
+{
+	if ( cleanOption.displayName == RECYCLE_BIN )
+	{
+		core::DirInfo dirInfo {};
+
+#ifdef _WIN32
+		SHQUERYRBINFO rbInfo {};
+		rbInfo.cbSize = sizeof( SHQUERYRBINFO );
+
+		const HRESULT hr = SHQueryRecycleBinA( nullptr, &rbInfo );
+		if ( SUCCEEDED( hr ) )
+		{
+			dirInfo.countFile = static_cast< uint64_t >( rbInfo.i64NumItems );
+			dirInfo.dirSize = static_cast< uint64_t >( rbInfo.i64Size );
+		}
+#else
+		for ( const fs::path& trashDir : findTrashDirs() )
+		{
+			const core::DirInfo trashInfo = measureTrash( trashDir );
+			dirInfo.countFile += trashInfo.countFile;
+			dirInfo.dirSize += trashInfo.dirSize;
+		}
+#endif
+
+		accumulateResult( common::SYSTEM, cleanOption.displayName, dirInfo );
+		reportOption( common::SYSTEM, cleanOption.displayName, pathDir, dirInfo );
+		return;
+	}
+
+	const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
+	const bool isBrowserItem = cleaningItem.itemType == common::ItemType::BROWSER;
+	DirRecords records;
+	core::DirInfo dirInfo;
+
+	// browser caches keep their own index, reading it avoids a stat per cache entry. the index knows no rules
+	const std::optional< core::DirInfo > indexedInfo = isBrowserItem && !rules ? readCacheIndex( pathDir ) : std::nullopt;
+	if ( indexedInfo.has_value() )
+	{
+		dirInfo = indexedInfo.value();
+		records.push_back( { .option = {}, .directory = {}, .dirSize = dirInfo.dirSize, .countFile = dirInfo.countFile } );
+	}
+	else
+	{
+		const ReportRow reportScope { .run = m_reportRun, .level = {}, .item = cleaningItem.name, .option = cleanOption.displayName, .path = {} };
+		dirInfo = processPath( pathDir, false, &records, &reportScope, rules );
+	}
+
+	{
+		std::scoped_lock lock( m_summaryMutex );
+		m_analysedOptions[ cleanOption.id ] = dirInfo;
+	}
+
+	accumulateResult( cleaningItem.name, cleanOption.displayName, dirInfo );
+	reportOption( cleaningItem.name, cleanOption.displayName, pathDir, dirInfo );
+	accumulateRecords( isCustomItem ? utils::pathToString( pathDir ) : cleaningItem.name + "/" + cleanOption.displayName, std::move( records ) );
+}
+
+void core::SystemCleaner::clearTargets( const common::CleaningItems& cleaningItems, IoScheduler& scheduler, ClearMode mode )
 {
 	resetData();
 	m_currentState = common::CleanerState::CLEANING;
+	m_reportRun = REPORT_CLEANING;
 
+	std::vector< IoWork > works;
 	for ( const common::CleaningItem& cleaningItem : cleaningItems )
 	{
-		if ( !cleaningItem.isNeedClean() )
+		const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
+		for ( const common::CleanOption& cleanOption : cleaningItem.cleanOptions )
 		{
-			continue;
+			if ( !cleanOption.enabled )
+			{
+				continue;
+			}
+
+			OptionTarget target = getOptionTarget( cleanOption.id, isCustomItem );
+			fs::path root = target.path;
+			works.push_back( { std::move( root ), [ this, &cleaningItem, &cleanOption, target = std::move( target ), mode ] ()
+			{
+				if ( !*m_cancelToken )
+				{
+					clearOption( cleaningItem, cleanOption, target.path, target.rules.get(), mode );
+				}
+			} } );
 		}
+	}
 
-		TaskManager::instance().addTask( [ this, cleaningItem ] ()
+	scheduler.schedule( std::move( works ) );
+}
+
+void core::SystemCleaner::clearOption( const common::CleaningItem& cleaningItem, const common::CleanOption& cleanOption, const fs::path& pathDir,
+	const TargetRules* rules, ClearMode mode )
+{
+	if ( cleanOption.displayName == RECYCLE_BIN )
+	{
+		core::DirInfo dirInfo;
+#ifdef _WIN32
+		SHQUERYRBINFO rbInfo {};
+		rbInfo.cbSize = sizeof( SHQUERYRBINFO );
+
+		const HRESULT hr = SHQueryRecycleBinA( nullptr, &rbInfo );
+		if ( SUCCEEDED( hr ) && rbInfo.i64NumItems > 0 )
 		{
-			cleanOptions( cleaningItem );
-		} );
+			dirInfo.countFile = static_cast< uint64_t >( rbInfo.i64NumItems );
+			dirInfo.dirSize = static_cast< uint64_t >( rbInfo.i64Size );
+
+			accumulateResult( common::SYSTEM, cleanOption.displayName, dirInfo );
+			reportOption( common::SYSTEM, cleanOption.displayName, pathDir, dirInfo );
+			SHEmptyRecycleBinA( nullptr, nullptr, SHERB_NOCONFIRMATION | SHERB_NOPROGRESSUI | SHERB_NOSOUND );
+		}
+#else
+		for ( const fs::path& trashDir : findTrashDirs() )
+		{
+			dirInfo.add( emptyTrash( trashDir ) );
+		}
+
+		accumulateResult( common::SYSTEM, cleanOption.displayName, dirInfo );
+		reportOption( common::SYSTEM, cleanOption.displayName, pathDir, dirInfo );
+#endif
+		return;
+	}
+
+	// rules pick single files, those options have to be walked
+	if ( mode == ClearMode::QUARANTINE && !rules && quarantineOption( cleaningItem, cleanOption, pathDir ) )
+	{
+		return;
 	}
+
+	const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
+	DirRecords records;
+	const ReportRow reportScope { .run = m_reportRun, .level = {}, .item = cleaningItem.name, .option = cleanOption.displayName, .path = {} };
+	const core::DirInfo dirInfo = processPath( pathDir, true, &records, &reportScope, rules );
+	accumulateResult( cleaningItem.name, cleanOption.displayName, dirInfo );
+	reportOption( cleaningItem.name, cleanOption.displayName, pathDir, dirInfo );
+	accumulateRecords( isCustomItem ? utils::pathToString( pathDir ) : cleaningItem.name + "/" + cleanOption.displayName, std::move( records ) );
 }
 
-void core::SystemCleaner::cleanOptions( const common::CleaningItem& cleaningItem )
+core::DirInfo core::SystemCleaner::emptyTrash( const fs::path& trashDir )
 {
-	const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
-	for ( const common::CleanOption& cleanOption : cleaningItem.cleanOptions )
+	const std::vector< fs::path > items = listTrashedItems( trashDir );
+	std::vector< core::DirInfo > removed( items.size() );
+	TaskManager::instance().parallelFor( items.size(), [ this, &items, &removed ] ( size_t i )
 	{
-		if ( !cleanOption.enabled )
+		// a trashed link is removed itself, the delete pass would walk the folder it points to
+		std::error_code ec;
+		core::DirInfo& itemInfo = removed[ i ];
+		if ( fs::is_symlink( items[ i ], ec ) )
 		{
-			continue;
+			itemInfo.countFile = fs::remove( items[ i ], ec ) ? 1 : 0;
 		}
-
-		if ( cleanOption.displayName == RECYCLE_BIN )
+		else
 		{
-			core::DirInfo dirInfo;
-			SHQUERYRBINFO rbInfo {};
-			rbInfo.cbSize = sizeof( SHQUERYRBINFO );
+			// the analysis counted items, so progress goes per item as well
+			itemInfo = processPath( items[ i ], true, nullptr, nullptr, nullptr, false );
+			// the delete pass keeps the folder it was given. items are counted like the recycle bin does, not per file
+			itemInfo.countFile = fs::remove( items[ i ], ec ) || !fs::exists( items[ i ], ec ) ? 1 : 0;
+		}
+		setProgress( static_cast< float >( ++m_cleanedFiles ) / static_cast< float >( m_filesToClean ) );
+	} );
 
-			const HRESULT hr = SHQueryRecycleBinA( nullptr, &rbInfo );
-			if ( SUCCEEDED( hr ) && rbInfo.i64NumItems > 0 )
-			{
-				dirInfo.countFile = static_cast< uint64_t >( rbInfo.i64NumItems );
-				dirInfo.dirSize = static_cast< uint64_t >( rbInfo.i64Size );
+	core::DirInfo info;
+	for ( const core::DirInfo& itemInfo : removed )
+	{
+		info.add( itemInfo );
+	}
 
-				accumulateResult( common::SYSTEM, cleanOption.displayName, dirInfo );
-				SHEmptyRecycleBinA( nullptr, nullptr, SHERB_NOCONFIRMATION | SHERB_NOPROGRESSUI | SHERB_NOSOUND );
-			}
-			continue;
+	pruneTrashInfo( trashDir );
+	return info;
+}
+
+bool core::SystemCleaner::quarantineOption( const common::CleaningItem& cleaningItem, const common::CleanOption& cleanOption, const fs::path& pathDir )
+{
+	DirInfo dirInfo;
+	{
+		std::scoped_lock lock( m_summaryMutex );
+		auto it = m_analysedOptions.find( cleanOption.id );
+		if ( it == m_analysedOptions.end() )
+		{
+			return false;
 		}
-		const fs::path& pathDir = isCustomItem ? m_customPathCache[ cleanOption.id ] : m_cleanPathCache[ cleanOption.id ];
-		const core::DirInfo dirInfo = processPath( pathDir, true );
-		accumulateResult( cleaningItem.name, cleanOption.displayName, dirInfo );
+		dirInfo = it->second;
 	}
+
+	// a rename takes open files along and frees nothing for them, such options are cleaned file by file.
+	// the index only knows regular files, so sockets and pipes someone may be using keep the option out too
+	if ( dirInfo.countFile == 0 || dirInfo.pinnedFiles > 0 || dirInfo.specialFiles > 0 || pathDir.empty() ||
+		utils::path::checkProtected( pathDir ) || isInSharedTemp( pathDir ) || m_openFileIndex.hasFilesUnder( pathDir ) ||
+		!m_quarantine->move( pathDir, STRUCTURAL_CACHE_DIRS ) )
+	{
+		return false;
+	}
+
+	// the files left the option with the rename, the analysis figures stand for them
+	m_cleanedFiles += dirInfo.countFile;
+	setProgress( static_cast< float >( m_cleanedFiles ) / static_cast< float >( m_filesToClean ) );
+
+	const bool isCustomItem = cleaningItem.itemType == common::ItemType::CUSTOM_PATH;
+	accumulateResult( cleaningItem.name, cleanOption.displayName, dirInfo );
+	reportOption( cleaningItem.name, cleanOption.displayName, pathDir, dirInfo );
+	accumulateRecords( isCustomItem ? utils::pathToString( pathDir ) : cleaningItem.name + "/" + cleanOption.displayName, {} );
+	return true;
 }
 
 void core::SystemCleaner::accumulateResult( std::string itemName, std::string category, const core::DirInfo dirInfo )
@@ -490,7 +1388,175 @@ void core::SystemCleaner::accumulateResult( std::string itemName, std::string ca
 	std::scoped_lock lock( m_summaryMutex );
 	m_summary.totalFiles += dirInfo.countFile;
 	m_summary.totalSize += dirInfo.dirSize;
-	m_summary.results.push_back( { std::move( itemName ), std::move( category ), dirInfo.countFile, dirInfo.dirSize } );
+	m_summary.removedDirs += dirInfo.removedDirs;
+	m_summary.pinnedFiles += dirInfo.pinnedFiles;
+	m_summary.pinnedSize += dirInfo.pinnedSize;
+	m_summary.errors.add( dirInfo.errors );
+	m_summary.results.push_back( {
+		.propertyName = std::move( itemName ),
+		.categoryName = std::move( category ),
+		.cleanedFiles = dirInfo.countFile,
+		.cleanedSize = dirInfo.dirSize,
+		.paths = {} } );
+}
+
+void core::SystemCleaner::reportOption( std::string_view itemName, std::string_view optionName, const fs::path& pathDir, const core::DirInfo& dirInfo )
+{
+	if ( !m_report.isOpen() )
+	{
+		return;
+	}
+
+	const std::string path = utils::pathToString( pathDir );
+	m_report.write( { .run = m_reportRun, .level = REPORT_OPTION, .item = itemName, .option = optionName,
+		.path = path, .files = dirInfo.countFile, .bytes = dirInfo.dirSize } );
+}
+
+void core::SystemCleaner::accumulateRecords( const std::string& optionKey, DirRecords records )
+{
+	for ( DirRecord& record : records )
+	{
+		record.option = optionKey;
+	}
+	m_snapshot.addOption( optionKey, std::move( records ) );
+}
+
+void core::SystemCleaner::saveSnapshot( common::SummaryType type )
+{
+	// a cut short run would make the next diff report everything it missed as growth
+	if ( *m_cancelToken )
+	{
+		m_snapshot.clear();
+		return;
+	}
+
+	std::error_code ec;
+	fs::create_directories( CONFIG_DIR, ec );
+	if ( fs::exists( CURRENT_SNAPSHOT_PATH, ec ) )
+	{
+		fs::rename( CURRENT_SNAPSHOT_PATH, PREVIOUS_SNAPSHOT_PATH, ec );
+	}
+
+	if ( !m_snapshot.finish( CURRENT_SNAPSHOT_PATH, PREVIOUS_SNAPSHOT_PATH ) )
+	{
+		return;
+	}
+
+	if ( type == common::SummaryType::ANALYSIS )
+	{
+		core::ScanDiff scanDiff = diffSnapshots( PREVIOUS_SNAPSHOT_PATH, CURRENT_SNAPSHOT_PATH, MAX_GROWTH_DIRECTORIES );
+
+		std::scoped_lock lock( m_summaryMutex );
+		m_scanDiff = std::move( scanDiff );
+	}
+}
+
+void core::SystemCleaner::logRun( common::SummaryType type, float duration )
+{
+	// a cut short run would show up as a sudden drop in every trend
+	if ( *m_cancelToken )
+	{
+		return;
+	}
+
+	RunEntry entry;
+	entry.type = type;
+	entry.time = std::chrono::system_clock::now();
+	entry.duration = duration;
+	{
+		std::scoped_lock lock( m_summaryMutex );
+		for ( const common::CleanResult& result : m_summary.results )
+		{
+			entry.options.push_back( { result.propertyName + "/" + result.categoryName, result.cleanedFiles, result.cleanedSize } );
+		}
+	}
+
+	m_runLog.append( entry );
+}
+
+void core::SystemCleaner::exportMetrics()
+{
+	// the file is written once per run, after the workers are done
+	common::Summary summary;
+	{
+		std::scoped_lock lock( m_summaryMutex );
+		summary = m_summary;
+	}
+	m_metrics.finishRun( summary );
+}
+
+void core::SystemCleaner::beginRun()
+{
+	// a timer of the previous run may still hold its token, it can not cancel this one
+	m_cancelToken = std::make_shared< std::atomic< bool > >( false );
+	m_progress = 0.f;
+	m_lastProgressNotify = 0;
+}
+
+void core::SystemCleaner::openReport()
+{
+	// a report that can not be created does not stop the run
+	if ( m_reportSettings.has_value() )
+	{
+		m_report.open( m_reportSettings.value() );
+	}
+}
+
+void core::SystemCleaner::scheduleTimeout( std::chrono::milliseconds timeout )
+{
+	if ( timeout.count() <= 0 )
+	{
+		return;
+	}
+
+	TaskManager::instance().addDelayedTask( [ cancelToken = m_cancelToken ] ()
+	{
+		*cancelToken = true;
+	}, timeout, TaskPriority::HIGH );
+}
+
+void core::SystemCleaner::setProgress( float progress )
+{
+	// files created after the analysis are removed too, the bar stops at full
+	progress = std::min( progress, 1.f );
+
+	// workers finish out of order, a value below the one already shown would move the bar back
+	float current = m_progress;
+	do
+	{
+		if ( progress <= current )
+		{
+			return;
+		}
+	} while ( !m_progress.compare_exchange_weak( current, progress ) );
+
+	const std::shared_ptr< const ProgressCallback > onProgress = m_onProgress.load();
+	if ( !onProgress && !m_changeListener )
+	{
+		return;
+	}
+
+	// one worker reports per interval, the final value is always reported
+	using clock = std::chrono::steady_clock;
+	const clock::rep now = clock::now().time_since_epoch().count();
+	clock::rep last = m_lastProgressNotify;
+	const bool isDue = now - last >= clock::duration( PROGRESS_NOTIFY_INTERVAL ).count();
+	if ( progress >= 1.f || ( isDue && m_lastProgressNotify.compare_exchange_strong( last, now ) ) )
+	{
+		if ( onProgress )
+		{
+			( *onProgress )( progress );
+		}
+		notifyChanged();
+	}
+}
+
+void core::SystemCleaner::notifyChanged()
+{
+	if ( m_changeListener )
+	{
+		m_changeListener();
+	}
 }
 
 void core::SystemCleaner::resetData()
@@ -500,8 +1566,17 @@ void core::SystemCleaner::resetData()
 		m_summary.results.clear();
 		m_summary.totalFiles = 0;
 		m_summary.totalSize = 0;
+		m_summary.removedDirs = 0;
+		m_summary.pinnedFiles = 0;
+		m_summary.pinnedSize = 0;
+		m_summary.concurrency = {};
+		m_summary.errors = {};
+		m_summary.isCancelled = false;
+		m_scanDiff = {};
 	}
+	m_snapshot.clear();
 
 	m_cleanedFiles = 0;
 	m_countAnalysTasks = 0;
+	m_countDoneTasks = 0;
 }
\ No newline at end of file
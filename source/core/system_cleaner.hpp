@@ -1,7 +1,11 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
 
 #include <filesystem>
 #include <string>
@@ -11,59 +15,214 @@
 #include "common/cleaner_info.hpp"
 #include "common/types.hpp"
 
+#include "core/async_task.hpp"
+#include "core/custom_path_index.hpp"
+#include "core/dir_info.hpp"
+#include "core/duplicate_finder.hpp"
+#include "core/io_scheduler.hpp"
+#include "core/metrics_exporter.hpp"
+#include "core/report_writer.hpp"
+#include "core/run_log.hpp"
+#include "core/open_file_index.hpp"
+#include "core/quarantine.hpp"
+#include "core/scan_diff.hpp"
+#include "core/scan_snapshot.hpp"
+#include "core/target_config.hpp"
+#include "core/task_manager.hpp"
+
 namespace core
 {
-	struct DirInfo
+	enum class ClearMode
+	{
+		DELETE,
+		// the contents of each option folder are renamed aside at once, the files are deleted in the background and the clear can be undone until then
+		QUARANTINE
+	};
+
+	using ProgressCallback = std::function< void( float ) >;
+
+	struct RunOptions
 	{
-		uint64_t dirSize = 0;
-		uint64_t countFile = 0;
+		// called from the workers, at most every few tens of milliseconds and once with 1.0 at the end
+		ProgressCallback onProgress;
+		// the run is cancelled after this, the summary then holds what was done so far. zero means no limit
+		std::chrono::milliseconds timeout { 0 };
+		// used by clearAsync only
+		ClearMode clearMode = ClearMode::DELETE;
 	};
 
 	class SystemCleaner
 	{
 	public:
+		SystemCleaner();
 		~SystemCleaner();
 
 		[[nodiscard]] common::Summary getSummary();
-
-		void clear( const common::CleaningItems& cleanTargets );
-		void analysis( const common::CleaningItems& cleanTargets );
+		// growth since the previous run, filled when analysis is done
+		[[nodiscard]] core::ScanDiff getScanDiff();
+
+		// start a run and return at once, the handle or getCurrentState tells when it is done.
+		// like the awaitable runs they throw std::logic_error unless the cleaner is idle
+		TaskHandle clear( const common::CleaningItems& cleanTargets, ClearMode mode = ClearMode::DELETE );
+		TaskHandle analysis( const common::CleaningItems& cleanTargets );
+		// identical files inside the enabled options, nothing is deleted
+		TaskHandle findDuplicates( const common::CleaningItems& cleanTargets );
+
+		// awaitable runs for embedders: they start when awaited and complete with the summary, e.g.
+		// common::Summary summary = co_await cleaner.analysisAsync( items, { .timeout = 30s } );
+		// awaiting one throws std::logic_error unless the cleaner is idle, i.e. no run is going and the last summary was taken
+		[[nodiscard]] Task< common::Summary > analysisAsync( common::CleaningItems cleanTargets, RunOptions options = {} );
+		[[nodiscard]] Task< common::Summary > clearAsync( common::CleaningItems cleanTargets, RunOptions options = {} );
+		// stops the current run at the next file, the summary is marked as cancelled
+		void cancel();
+		// options moved aside by a quarantine clear that have not been purged yet
+		[[nodiscard]] bool canUndoClear() const;
+		// puts them back on the task pool, how many options were restored arrives through takeRestoredCount
+		void undoClear();
+		[[nodiscard]] std::optional< size_t > takeRestoredCount();
+		// every following analysis or cleaning streams its results to this report, nullopt turns it off
+		void setReport( std::optional< ReportSettings > settings );
+		// after every analysis or cleaning the latest figures are written to this Prometheus textfile, nullopt turns it off
+		void setMetricsFile( std::optional< fs::path > path );
+		// growth of each option over the logged runs and when it passes thresholdBytes at that rate
+		[[nodiscard]] std::vector< OptionTrend > getTrends( uint64_t thresholdBytes ) const;
 
 		common::CleanerState getCurrentState();
 		float getCurrentProgress();
+		// called from any thread when progress, the state, discovered items or import results change.
+		// set it before collectCleaningItems, it is not guarded
+		void setChangeListener( std::function< void() > listener );
 
+		// returns the custom paths item at once. the other sections are probed in the background and arrive
+		// through takeDiscoveredItems as each finishes, saved custom paths through takeImportResults.
+		// targets of CONFIG_DIR/targets.ini arrive the same way, and again whenever the file changes
 		[[nodiscard]] common::CleaningItems collectCleaningItems();
+		[[nodiscard]] common::DiscoveredItems takeDiscoveredItems();
+		// every startup section has been queued for take*
+		[[nodiscard]] bool isStartupDone() const;
 
 		[[nodiscard]] common::PathAdditionResult addCustomPath( const fs::path& path );
+		// expands glob patterns and validates every path on the task pool, the results are applied as one batch
+		void importCustomPaths( std::vector< std::string > sources, bool isRestore = false );
+		// one path or glob pattern per line
+		void importCustomPathList( const fs::path& listFile );
+		[[nodiscard]] std::vector< common::ImportResult > takeImportResults();
 		void removeCustomPath( uint64_t id );
 		[[nodiscard]] common::OptionalString getFullPath( uint64_t id );
 	private:
-		void initBrowserData( common::CleaningItems& cleaningItems );
-		void initSystemTempData( common::CleaningItems& cleaningItems );
-		void initCustomPaths( common::CleaningItems& cleaningItems );
+		void initBrowserData();
+		void initSystemTempData();
+		void initCustomPaths();
+		void loadTargets();
+		void watchTargets();
+		void addDiscoveredItems( common::CleaningItems items );
+
+		void runImport( const std::vector< std::string >& sources, bool isRestore );
+		[[nodiscard]] common::PathAdditionResult insertCustomPath( const fs::path& path, CustomPathIndex::Key key );
+		[[nodiscard]] fs::path getOptionPath( uint64_t id, bool isCustom );
+
+		struct OptionTarget
+		{
+			fs::path path;
+			std::shared_ptr< const TargetRules > rules;
+		};
+		// path and rules are taken under one lock, a targets reload in between could pair a path with no or other rules
+		[[nodiscard]] OptionTarget getOptionTarget( uint64_t id, bool isCustom );
 
 		void fini();
 
-		[[nodiscard]] DirInfo processPath( const fs::path& pathDir, bool deleteFiles = false );
-
-		void analysisTargets( const common::CleaningItems& cleaningItems );
-		void analysisOptions( const common::CleaningItem& cleaningItem );
-		void clearTargets( const common::CleaningItems& cleaningItems );
-		void cleanOptions( const common::CleaningItem& cleaningItem );
+		// reportScope names the item and option of detailed report rows, files the rules do not accept are left alone.
+		// without isFileProgress removed files do not count towards the progress, the caller counts its own units.
+		// an analysis pass lists every file it accepts into foundFiles when one is given
+		[[nodiscard]] DirInfo processPath( const fs::path& pathDir, bool deleteFiles = false, DirRecords* records = nullptr,
+			const ReportRow* reportScope = nullptr, const TargetRules* rules = nullptr, bool isFileProgress = true,
+			std::vector< DuplicateCandidate >* foundFiles = nullptr );
+
+		// the targets are referenced by the tasks, they have to outlive the scheduler's group
+		void analysisTargets( const common::CleaningItems& cleaningItems, IoScheduler& scheduler );
+		void analysisOption( const common::CleaningItem& cleaningItem, const common::CleanOption& cleanOption, const fs::path& pathDir,
+			const TargetRules* rules );
+		void clearTargets( const common::CleaningItems& cleaningItems, IoScheduler& scheduler, ClearMode mode );
+		void clearOption( const common::CleaningItem& cleaningItem, const common::CleanOption& cleanOption, const fs::path& pathDir,
+			const TargetRules* rules, ClearMode mode );
+		// true when the option's contents were renamed aside, its result is taken from the analysis that came before
+		bool quarantineOption( const common::CleaningItem& cleaningItem, const common::CleanOption& cleanOption, const fs::path& pathDir );
+		// empties a freedesktop trash folder item by item on the task pool
+		[[nodiscard]] DirInfo emptyTrash( const fs::path& trashDir );
 
 		void accumulateResult( std::string itemName, std::string category, const core::DirInfo dirInfo );
-
+		void reportOption( std::string_view itemName, std::string_view optionName, const fs::path& pathDir, const core::DirInfo& dirInfo );
+		void accumulateRecords( const std::string& optionKey, DirRecords records );
+		void saveSnapshot( common::SummaryType type );
+		void logRun( common::SummaryType type, float duration );
+		void exportMetrics();
+
+		void beginRun();
+		void openReport();
+		void scheduleTimeout( std::chrono::milliseconds timeout );
+		// throws when a run is still going, marks the cleaner busy otherwise
+		void claimIdle();
+		// the runs behind clear and analysis, the caller has claimed the cleaner
+		TaskHandle startClear( const common::CleaningItems& cleanTargets, ClearMode mode );
+		TaskHandle startAnalysis( const common::CleaningItems& cleanTargets );
+		void setProgress( float progress );
+		void notifyChanged();
 		void resetData();
 
 		std::atomic< uint64_t > m_cleanedFiles { 0 };
+		std::atomic< uint64_t > m_filesToClean { 0 };
 		std::atomic< float > m_progress { 0.f };
 		std::atomic< size_t > m_countAnalysTasks { 0 };
+		std::atomic< size_t > m_countDoneTasks { 0 };
+		std::shared_ptr< std::atomic< bool > > m_cancelToken = std::make_shared< std::atomic< bool > >( false );
+		// swapped by the async runs while workers of a previous run may still report
+		std::atomic< std::shared_ptr< const ProgressCallback > > m_onProgress;
+		std::function< void() > m_changeListener;
+		std::atomic< std::chrono::steady_clock::rep > m_lastProgressNotify { 0 };
 
 		std::mutex m_summaryMutex;
 		common::Summary m_summary;
-
+		core::ScanDiff m_scanDiff;
+		// per option id, what the analysis pass found
+		std::unordered_map< uint64_t, DirInfo > m_analysedOptions;
+		// set by an undo once it is done, until taken
+		std::optional< size_t > m_restoredCount;
+
+		// built before each clean, read only while files are deleted
+		OpenFileIndex m_openFileIndex;
+		std::optional< ReportSettings > m_reportSettings;
+		ReportWriter m_report;
+		// phase the report rows belong to, a cleaning run analyses first
+		std::string_view m_reportRun;
+		RunLog m_runLog;
+		MetricsExporter m_metrics;
+		// shared with the delayed purges, they may run after the cleaner is gone
+		std::shared_ptr< Quarantine > m_quarantine;
+
+		SnapshotWriter m_snapshot;
+
+		std::mutex m_cleanPathMutex;
 		std::unordered_map< uint64_t, fs::path > m_cleanPathCache;
+		std::unordered_map< uint64_t, std::shared_ptr< const TargetRules > > m_optionRules;
+		common::DiscoveredItems m_discoveredItems;
+		std::vector< uint64_t > m_targetOptionIds;
+
+		// the polling task holds this, it stops once the cleaner is gone
+		struct TargetsWatch
+		{
+			std::mutex mutex;
+			bool isActive = true;
+			std::optional< fs::file_time_type > lastWriteTime;
+		};
+		std::shared_ptr< TargetsWatch > m_targetsWatch = std::make_shared< TargetsWatch >();
+
+		std::mutex m_customPathMutex;
 		std::unordered_map< uint64_t, fs::path > m_customPathCache;
+		CustomPathIndex m_customPathIndex;
+		std::vector< common::ImportResult > m_importResults;
+		// background discovery and imports still using this object
+		TaskGroup m_startupJobs { TaskPriority::HIGH };
+		TaskGroup m_backgroundJobs;
 		std::atomic < common::CleanerState > m_currentState = common::CleanerState::IDLE;
 	};
 }
\ No newline at end of file
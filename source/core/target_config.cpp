@@ -0,0 +1,319 @@
+#include "target_config.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+
+#include "core/task_manager.hpp"
+#include "utils/filesystem.hpp"
+#include "utils/glob.hpp"
+#include "utils/path_validator.hpp"
+
+namespace
+{
+	constexpr std::string_view WHITESPACE = " \t\r";
+	constexpr std::string_view COMMENT_CHARS = ";#";
+	constexpr std::string_view INLINE_COMMENT = " ;";
+	constexpr char OPTION_SEPARATOR = '|';
+	constexpr int64_t MAX_AGE_DAYS = 100 * 365;
+
+	struct RawOption
+	{
+		size_t line = 0;
+		std::string displayName;
+		std::string pattern;
+		core::TargetRules rules;
+	};
+
+	struct RawTarget
+	{
+		std::string name;
+		common::ItemType itemType = common::ItemType::TEMP;
+		// copied into every option that follows
+		core::TargetRules rules;
+		std::vector< RawOption > options;
+	};
+
+	struct ResolvedOption
+	{
+		std::vector< fs::path > paths;
+		std::string error;
+	};
+
+	std::string_view trim( std::string_view str )
+	{
+		const size_t first = str.find_first_not_of( WHITESPACE );
+		if ( first == std::string_view::npos )
+		{
+			return {};
+		}
+		return str.substr( first, str.find_last_not_of( WHITESPACE ) - first + 1 );
+	}
+
+	std::string lineError( size_t line, std::string_view message )
+	{
+		return "line " + std::to_string( line ) + ": " + std::string( message );
+	}
+
+	// %NAME% and ${NAME} come from the environment, a leading ~ is the home folder
+	std::optional< std::string > expandVariables( std::string_view pattern, std::string& error )
+	{
+		std::string result;
+		if ( pattern.starts_with( '~' ) )
+		{
+			result = utils::pathToString( utils::FileSystem::instance().getHomeDir() );
+			pattern.remove_prefix( 1 );
+		}
+
+		while ( !pattern.empty() )
+		{
+			const size_t percent = pattern.find( '%' );
+			const size_t dollar = pattern.find( "${" );
+			const size_t start = std::min( percent, dollar );
+			result += pattern.substr( 0, start );
+			if ( start == std::string_view::npos )
+			{
+				break;
+			}
+
+			const bool isPercent = start == percent;
+			const size_t nameStart = start + ( isPercent ? 1 : 2 );
+			const size_t nameEnd = pattern.find( isPercent ? '%' : '}', nameStart );
+			if ( nameEnd == std::string_view::npos )
+			{
+				error = "unclosed variable";
+				return std::nullopt;
+			}
+
+			const std::string name( pattern.substr( nameStart, nameEnd - nameStart ) );
+			const char* value = std::getenv( name.c_str() );
+			if ( !value )
+			{
+				error = "unknown variable " + name;
+				return std::nullopt;
+			}
+
+			result += value;
+			pattern.remove_prefix( nameEnd + 1 );
+		}
+		return result;
+	}
+
+	bool applyRule( core::TargetRules& rules, std::string_view key, std::string_view value, std::string& error )
+	{
+		if ( key == "exclude" )
+		{
+			rules.excludes.push_back( fs::path( std::string( value ) ).native() );
+			return true;
+		}
+
+		if ( key == "min_age_days" )
+		{
+			int64_t days = 0;
+			const std::from_chars_result result = std::from_chars( value.data(), value.data() + value.size(), days );
+			if ( result.ec != std::errc() || result.ptr != value.data() + value.size() || days < 0 || days > MAX_AGE_DAYS )
+			{
+				error = "min_age_days takes a number of days";
+				return false;
+			}
+			rules.minAge = std::chrono::days( days );
+			return true;
+		}
+
+		error = "unknown key " + std::string( key );
+		return false;
+	}
+
+	std::vector< RawTarget > parse( std::istream& input, std::vector< std::string >& errors )
+	{
+		std::vector< RawTarget > targets;
+		std::string line;
+		size_t lineNumber = 0;
+		while ( std::getline( input, line ) )
+		{
+			++lineNumber;
+			const std::string_view text = trim( line );
+			if ( text.empty() || COMMENT_CHARS.find( text.front() ) != std::string_view::npos )
+			{
+				continue;
+			}
+
+			if ( text.front() == '[' )
+			{
+				const std::string_view name = text.back() == ']' ? trim( text.substr( 1, text.size() - 2 ) ) : std::string_view();
+				if ( name.empty() )
+				{
+					errors.push_back( lineError( lineNumber, "expected [target name]" ) );
+					continue;
+				}
+				targets.push_back( { .name = std::string( name ), .rules = {}, .options = {} } );
+				continue;
+			}
+
+			const size_t equals = text.find( '=' );
+			if ( equals == std::string_view::npos || targets.empty() )
+			{
+				errors.push_back( lineError( lineNumber, targets.empty() ? "expected [target name] first" : "expected key = value" ) );
+				continue;
+			}
+
+			const std::string_view key = trim( text.substr( 0, equals ) );
+			std::string_view value = trim( text.substr( equals + 1 ) );
+			value = trim( value.substr( 0, value.find( INLINE_COMMENT ) ) );
+
+			RawTarget& target = targets.back();
+			if ( key == "type" )
+			{
+				if ( value == "browser" )
+				{
+					target.itemType = common::ItemType::BROWSER;
+				}
+				else if ( value == "temp" )
+				{
+					target.itemType = common::ItemType::TEMP;
+				}
+				else if ( value == "system" )
+				{
+					target.itemType = common::ItemType::SYSTEM;
+				}
+				else
+				{
+					errors.push_back( lineError( lineNumber, "type is browser, temp or system" ) );
+				}
+			}
+			else if ( key == "option" )
+			{
+				const size_t separator = value.find( OPTION_SEPARATOR );
+				const std::string_view displayName = trim( value.substr( 0, separator ) );
+				const std::string_view pattern = separator == std::string_view::npos ? std::string_view() : trim( value.substr( separator + 1 ) );
+				if ( displayName.empty() || pattern.empty() )
+				{
+					errors.push_back( lineError( lineNumber, "expected option = name | path" ) );
+					continue;
+				}
+				target.options.push_back( { lineNumber, std::string( displayName ), std::string( pattern ), target.rules } );
+			}
+			else
+			{
+				std::string error;
+				if ( !applyRule( target.options.empty() ? target.rules : target.options.back().rules, key, value, error ) )
+				{
+					errors.push_back( lineError( lineNumber, error ) );
+				}
+			}
+		}
+		return targets;
+	}
+}
+
+bool core::TargetRules::isEmpty() const noexcept
+{
+	return minAge.count() == 0 && excludes.empty();
+}
+
+bool core::TargetRules::accepts( const fs::directory_entry& entry, fs::file_time_type now ) const
+{
+	const fs::path fileName = entry.path().filename();
+	for ( const fs::path::string_type& exclude : excludes )
+	{
+		if ( utils::glob::match( exclude, fileName.native() ) )
+		{
+			return false;
+		}
+	}
+
+	if ( minAge.count() == 0 )
+	{
+		return true;
+	}
+
+	// the directory iterator already holds the time on Windows, elsewhere this is a stat
+	std::error_code ec;
+	const fs::file_time_type writeTime = entry.last_write_time( ec );
+	return !ec && writeTime + minAge <= now;
+}
+
+core::TargetConfig core::loadTargetConfig( const fs::path& path )
+{
+	TargetConfig config;
+	std::ifstream input( path );
+	if ( !input )
+	{
+		return config;
+	}
+
+	std::vector< RawTarget > rawTargets = parse( input, config.errors );
+
+	std::vector< const RawOption* > rawOptions;
+	for ( const RawTarget& rawTarget : rawTargets )
+	{
+		for ( const RawOption& rawOption : rawTarget.options )
+		{
+			rawOptions.push_back( &rawOption );
+		}
+	}
+
+	// globs and validation touch the disk, the options are resolved in parallel
+	std::vector< ResolvedOption > resolved( rawOptions.size() );
+	TaskManager::instance().parallelFor( rawOptions.size(), [ & ] ( size_t i )
+	{
+		const std::optional< std::string > pattern = expandVariables( rawOptions[ i ]->pattern, resolved[ i ].error );
+		if ( !pattern.has_value() )
+		{
+			return;
+		}
+
+		for ( fs::path& match : utils::glob::expand( fs::path( pattern.value() ) ) )
+		{
+			// a target of a program that is not installed is not an error
+			std::error_code ec;
+			if ( !fs::exists( match, ec ) )
+			{
+				continue;
+			}
+
+			if ( const common::OptionalString error = utils::path::validate( match ) )
+			{
+				resolved[ i ].error = utils::pathToString( match ) + ": " + error.value();
+				continue;
+			}
+			resolved[ i ].paths.push_back( std::move( match ) );
+		}
+
+		// directory order differs between runs, the options keep their place in the list
+		std::sort( resolved[ i ].paths.begin(), resolved[ i ].paths.end() );
+	} );
+
+	size_t optionIndex = 0;
+	for ( RawTarget& rawTarget : rawTargets )
+	{
+		TargetDefinition target { .name = std::move( rawTarget.name ), .itemType = rawTarget.itemType, .options = {} };
+		for ( RawOption& rawOption : rawTarget.options )
+		{
+			ResolvedOption& option = resolved[ optionIndex++ ];
+			if ( !option.error.empty() )
+			{
+				config.errors.push_back( lineError( rawOption.line, option.error ) );
+			}
+
+			// the folders matched by one option share its rules
+			const std::shared_ptr< const TargetRules > rules = rawOption.rules.isEmpty() ?
+				nullptr : std::make_shared< const TargetRules >( std::move( rawOption.rules ) );
+			for ( fs::path& optionPath : option.paths )
+			{
+				std::string displayName = option.paths.size() == 1 ? rawOption.displayName :
+					rawOption.displayName + " (" + utils::pathToString( optionPath.filename() ) + ")";
+				target.options.push_back( { std::move( displayName ), std::move( optionPath ), rules } );
+			}
+		}
+
+		if ( !target.options.empty() )
+		{
+			config.targets.push_back( std::move( target ) );
+		}
+	}
+
+	return config;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/cleaner_info.hpp"
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// limits on the files taken from inside a configured option
+	struct TargetRules
+	{
+		// files changed more recently than this are left alone
+		std::chrono::hours minAge { 0 };
+		// file name globs that are never taken
+		std::vector< fs::path::string_type > excludes;
+
+		[[nodiscard]] bool isEmpty() const noexcept;
+		[[nodiscard]] bool accepts( const fs::directory_entry& entry, fs::file_time_type now ) const;
+	};
+
+	struct TargetOption
+	{
+		std::string displayName;
+		fs::path path;
+		// null when the option takes every file
+		std::shared_ptr< const TargetRules > rules;
+	};
+
+	struct TargetDefinition
+	{
+		std::string name;
+		common::ItemType itemType = common::ItemType::TEMP;
+		std::vector< TargetOption > options;
+	};
+
+	struct TargetConfig
+	{
+		std::vector< TargetDefinition > targets;
+		// "line N: ..." for every line that was skipped
+		std::vector< std::string > errors;
+	};
+
+	// reads the targets file and compiles it for the engine: variables are expanded, globs resolved
+	// against the disk and the paths validated. an option matching several folders becomes one option per folder.
+	//
+	// [Discord]
+	// type = temp                         ; browser, temp or system: the tab the item is shown in
+	// min_age_days = 2                    ; rules before the first option apply to all of them
+	// option = Cache | %APPDATA%/discord/Cache
+	// option = Logs | ${HOME}/.config/discord/logs
+	// exclude = *.lock                    ; rules after an option apply to that option only
+	[[nodiscard]] TargetConfig loadTargetConfig( const fs::path& path );
+}
\ No newline at end of file
@@ -1,15 +1,386 @@
 #include "task_manager.hpp"
 
-core::TaskManager::TaskManager() : m_treadPool( std::thread::hardware_concurrency() )
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace
+{
+	constexpr size_t NO_WORKER = SIZE_MAX;
+	// a waiter that found nothing to run looks again after this, in case its tasks spawned new ones
+	constexpr std::chrono::milliseconds HELP_INTERVAL( 1 );
+
+	thread_local size_t t_workerIndex = NO_WORKER;
+	// nested tasks and loops inherit the priority of the task that creates them
+	thread_local core::TaskPriority t_priority = core::TaskPriority::NORMAL;
+}
+
+void core::detail::GroupState::wait()
+{
+	// other threads, the UI one above all, only block. helping could hand them any queued task, a long clean included
+	if ( t_workerIndex == NO_WORKER )
+	{
+		std::unique_lock lock( mutex );
+		finished.wait( lock, [ this ] ()
+		{
+			return pending == 0;
+		} );
+		return;
+	}
+
+	TaskManager& taskManager = TaskManager::instance();
+	while ( pending > 0 )
+	{
+		if ( taskManager.tryRunTask() )
+		{
+			continue;
+		}
+
+		std::unique_lock lock( mutex );
+		finished.wait_for( lock, HELP_INTERVAL, [ this ] ()
+		{
+			return pending == 0;
+		} );
+	}
+}
+
+bool core::detail::GroupState::addContinuation( std::function< void() > continuation )
+{
+	std::scoped_lock lock( mutex );
+	if ( pending == 0 )
+	{
+		return false;
+	}
+
+	continuations.push_back( std::move( continuation ) );
+	return true;
+}
+
+void core::detail::GroupState::complete()
+{
+	std::vector< std::function< void() > > toRun;
+	{
+		std::scoped_lock lock( mutex );
+		finished.notify_all();
+		toRun.swap( continuations );
+	}
+
+	for ( std::function< void() >& continuation : toRun )
+	{
+		continuation();
+	}
+}
+
+void core::TaskHandle::wait()
+{
+	if ( m_state )
+	{
+		m_state->wait();
+	}
+}
+
+bool core::TaskHandle::isDone() const
+{
+	return !m_state || m_state->pending == 0;
+}
+
+void core::TaskHandle::resumeOnPool( std::coroutine_handle<> handle )
+{
+	TaskManager::instance().addTask( [ handle ] ()
+	{
+		handle.resume();
+	}, t_priority );
+}
+
+core::TaskGroup::TaskGroup( TaskPriority priority ) : m_priority( priority ), m_state( std::make_shared< detail::GroupState >() )
+{
+}
+
+core::TaskGroup::~TaskGroup()
+{
+	// tasks usually reference the scope that owns the group
+	wait();
+}
+
+void core::TaskGroup::run( std::function< void() > task )
 {
+	++m_state->pending;
+	TaskManager::instance().submit( { std::move( task ), m_state, m_priority } );
 }
 
-void core::TaskManager::addTask( std::function<void()> task )
+void core::TaskGroup::wait()
 {
-	m_treadPool.submit_task( std::move( task ) );
+	m_state->wait();
 }
 
-size_t core::TaskManager::countActiveTasks()
+bool core::TaskGroup::isDone() const
 {
-	return m_treadPool.get_tasks_total();
+	return m_state->pending == 0;
 }
+
+core::TaskManager::TaskManager()
+{
+	const size_t threadCount = std::max( 1u, std::thread::hardware_concurrency() );
+	for ( size_t i = 0; i < threadCount; ++i )
+	{
+		m_workerQueues.push_back( std::make_unique< TaskQueues >() );
+	}
+
+	for ( size_t i = 0; i < threadCount; ++i )
+	{
+		m_workers.emplace_back( [ this, i ] ()
+		{
+			workerLoop( i );
+		} );
+	}
+}
+
+core::TaskManager::~TaskManager()
+{
+	{
+		std::scoped_lock lock( m_sleepMutex );
+		m_isStopping = true;
+	}
+	m_wakeUp.notify_all();
+
+	for ( std::thread& worker : m_workers )
+	{
+		worker.join();
+	}
+}
+
+core::TaskHandle core::TaskManager::addTask( std::function< void() > task, TaskPriority priority )
+{
+	auto state = std::make_shared< detail::GroupState >();
+	state->pending = 1;
+	submit( { std::move( task ), state, priority } );
+	return TaskHandle( std::move( state ) );
+}
+
+void core::TaskManager::addDelayedTask( std::function< void() > task, std::chrono::milliseconds delay, TaskPriority priority )
+{
+	auto state = std::make_shared< detail::GroupState >();
+	state->pending = 1;
+
+	const clock::time_point deadline = clock::now() + delay;
+	{
+		std::scoped_lock lock( m_sleepMutex );
+		m_timers.push_back( { deadline, { std::move( task ), std::move( state ), priority } } );
+		std::push_heap( m_timers.begin(), m_timers.end(), std::greater<>() );
+		m_nextDeadline = m_timers.front().deadline.time_since_epoch().count();
+	}
+
+	// a sleeping worker has to recompute its wake up time
+	m_wakeUp.notify_one();
+}
+
+size_t core::TaskManager::getThreadCount() const noexcept
+{
+	return m_workers.size();
+}
+
+void core::TaskManager::parallelFor( size_t count, std::function< void( size_t ) > body )
+{
+	if ( count == 0 )
+	{
+		return;
+	}
+
+	// indices are claimed only by running threads, a helper that starts late finds nothing left and exits
+	std::atomic< size_t > next { 0 };
+	auto runLoop = [ &next, &body, count ] ()
+	{
+		for ( size_t i = next++; i < count; i = next++ )
+		{
+			body( i );
+		}
+	};
+
+	TaskGroup group( t_priority );
+	const size_t helpers = std::min( count, getThreadCount() ) - 1;
+	for ( size_t i = 0; i < helpers; ++i )
+	{
+		group.run( runLoop );
+	}
+
+	runLoop();
+	group.wait();
+}
+
+void core::TaskManager::submit( Task task )
+{
+	const size_t priority = static_cast< size_t >( task.priority );
+
+	// a worker keeps its own tasks close, they are likely to touch the same data
+	TaskQueues& target = t_workerIndex != NO_WORKER ? *m_workerQueues[ t_workerIndex ] : m_sharedQueues;
+	{
+		std::scoped_lock lock( target.mutex );
+		target.queues[ priority ].push_back( std::move( task ) );
+		++target.counts[ priority ];
+		++m_queuedTasks;
+	}
+
+	// taking the lock orders the notification after a worker that is about to sleep has checked the counter
+	{
+		std::scoped_lock lock( m_sleepMutex );
+	}
+	m_wakeUp.notify_one();
+}
+
+bool core::TaskManager::tryRunTask()
+{
+	submitDueTimers();
+
+	Task task;
+	if ( !findTask( task ) )
+	{
+		return false;
+	}
+
+	runTask( task );
+	return true;
+}
+
+bool core::TaskManager::findTask( Task& task )
+{
+	if ( m_queuedTasks == 0 )
+	{
+		return false;
+	}
+
+	auto take = [ this, &task ] ( TaskQueues& source, size_t priority, bool isOwn )
+	{
+		// an empty queue is skipped without taking its lock
+		if ( source.counts[ priority ] == 0 )
+		{
+			return false;
+		}
+
+		std::scoped_lock lock( source.mutex );
+		std::deque< Task >& queue = source.queues[ priority ];
+		if ( queue.empty() )
+		{
+			return false;
+		}
+
+		if ( isOwn )
+		{
+			task = std::move( queue.back() );
+			queue.pop_back();
+		}
+		else
+		{
+			task = std::move( queue.front() );
+			queue.pop_front();
+		}
+		--source.counts[ priority ];
+		--m_queuedTasks;
+		return true;
+	};
+
+	const size_t workerCount = m_workerQueues.size();
+	for ( size_t priority = 0; priority < PRIORITY_COUNT; ++priority )
+	{
+		if ( t_workerIndex != NO_WORKER && take( *m_workerQueues[ t_workerIndex ], priority, true ) )
+		{
+			return true;
+		}
+
+		if ( take( m_sharedQueues, priority, false ) )
+		{
+			return true;
+		}
+
+		// victims are visited starting next to the thief, so thieves spread over the workers
+		const size_t start = t_workerIndex != NO_WORKER ? t_workerIndex + 1 : 0;
+		for ( size_t i = 0; i < workerCount; ++i )
+		{
+			const size_t victim = ( start + i ) % workerCount;
+			if ( victim != t_workerIndex && take( *m_workerQueues[ victim ], priority, false ) )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void core::TaskManager::submitDueTimers()
+{
+	const clock::time_point now = clock::now();
+	if ( now.time_since_epoch().count() < m_nextDeadline )
+	{
+		return;
+	}
+
+	std::vector< Task > dueTasks;
+	{
+		std::scoped_lock lock( m_sleepMutex );
+		while ( !m_timers.empty() && m_timers.front().deadline <= now )
+		{
+			std::pop_heap( m_timers.begin(), m_timers.end(), std::greater<>() );
+			dueTasks.push_back( std::move( m_timers.back().task ) );
+			m_timers.pop_back();
+		}
+		m_nextDeadline = m_timers.empty() ? clock::time_point::max().time_since_epoch().count() : m_timers.front().deadline.time_since_epoch().count();
+	}
+
+	// submit takes the sleep lock, so the tasks are queued after it is released
+	for ( Task& task : dueTasks )
+	{
+		submit( std::move( task ) );
+	}
+}
+
+void core::TaskManager::runTask( Task& task )
+{
+	const TaskPriority outerPriority = std::exchange( t_priority, task.priority );
+	try
+	{
+		task.body();
+	}
+	catch ( ... ) {}
+	t_priority = outerPriority;
+
+	detail::GroupState& group = *task.group;
+	if ( --group.pending == 0 )
+	{
+		group.complete();
+	}
+}
+
+void core::TaskManager::workerLoop( size_t index )
+{
+	t_workerIndex = index;
+	while ( true )
+	{
+		if ( tryRunTask() )
+		{
+			continue;
+		}
+
+		std::unique_lock lock( m_sleepMutex );
+		auto isAwake = [ this ] ()
+		{
+			return m_queuedTasks > 0 || m_isStopping || clock::now().time_since_epoch().count() >= m_nextDeadline;
+		};
+
+		// the wait is chosen again after every wake up, a timer added meanwhile changes the deadline
+		while ( !isAwake() )
+		{
+			if ( m_timers.empty() )
+			{
+				m_wakeUp.wait( lock );
+			}
+			else
+			{
+				m_wakeUp.wait_until( lock, m_timers.front().deadline );
+			}
+		}
+
+		if ( m_isStopping && m_queuedTasks == 0 )
+		{
+			return;
+		}
+	}
+}
\ No newline at end of file
@@ -1,11 +1,110 @@
 #pragma once
 
-#include <BS_thread_pool.hpp>
-
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace core
 {
+	enum class TaskPriority : size_t
+	{
+		// analysis the user is waiting for
+		HIGH,
+		NORMAL,
+		// cleaning and other work nobody is watching
+		LOW,
+		COUNT
+	};
+
+	namespace detail
+	{
+		struct GroupState
+		{
+			std::atomic< size_t > pending { 0 };
+			std::mutex mutex;
+			std::condition_variable finished;
+			std::vector< std::function< void() > > continuations;
+
+			// on a worker, runs queued tasks until pending reaches zero
+			void wait();
+			// false when the group is already done, the continuation is then not stored
+			bool addContinuation( std::function< void() > continuation );
+			void complete();
+		};
+	}
+
+	// join handle of a single task
+	class TaskHandle
+	{
+	public:
+		TaskHandle() = default;
+
+		void wait();
+		[[nodiscard]] bool isDone() const;
+
+		// co_await resumes the coroutine on the pool once the task is done
+		[[nodiscard]] auto operator co_await() const noexcept
+		{
+			struct Awaiter
+			{
+				std::shared_ptr< detail::GroupState > state;
+
+				bool await_ready() const noexcept
+				{
+					return !state || state->pending == 0;
+				}
+
+				bool await_suspend( std::coroutine_handle<> handle ) const
+				{
+					return state->addContinuation( [ handle ] ()
+					{
+						resumeOnPool( handle );
+					} );
+				}
+
+				void await_resume() const noexcept {}
+			};
+			return Awaiter { m_state };
+		}
+
+	private:
+		friend class TaskManager;
+		static void resumeOnPool( std::coroutine_handle<> handle );
+
+		explicit TaskHandle( std::shared_ptr< detail::GroupState > state ) : m_state( std::move( state ) ) {}
+
+		std::shared_ptr< detail::GroupState > m_state;
+	};
+
+	// tasks that are awaited together, a run can only wait for its own work.
+	// a waiting worker executes queued tasks meanwhile, so a task may wait for a group it created. other threads just block
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup( TaskPriority priority = TaskPriority::NORMAL );
+		~TaskGroup();
+		TaskGroup( const TaskGroup& ) = delete;
+		TaskGroup& operator = ( const TaskGroup& ) = delete;
+
+		void run( std::function< void() > task );
+		void wait();
+		[[nodiscard]] bool isDone() const;
+
+	private:
+		TaskPriority m_priority;
+		std::shared_ptr< detail::GroupState > m_state;
+	};
+
+	// work-stealing scheduler: each worker pops its own deque from the back and steals from the front of the others.
+	// tasks submitted outside the workers go to a shared queue, a higher priority is always taken first
 	class TaskManager
 	{
 	public:
@@ -15,15 +114,72 @@ namespace core
 			return taskManager;
 		}
 
-		void addTask( std::function< void() > task );
-		size_t countActiveTasks();
+		TaskHandle addTask( std::function< void() > task, TaskPriority priority = TaskPriority::NORMAL );
+		// queued once the delay has passed. timers are checked by idle and waiting threads, there is no timer thread
+		void addDelayedTask( std::function< void() > task, std::chrono::milliseconds delay, TaskPriority priority = TaskPriority::NORMAL );
+		[[nodiscard]] size_t getThreadCount() const noexcept;
+
+		// runs body( i ) for every i in [0, count) and returns when all of them are done.
+		// the calling thread takes part, so it is safe to call from inside a task
+		void parallelFor( size_t count, std::function< void( size_t ) > body );
 
 	private:
+		friend class TaskGroup;
+		friend struct detail::GroupState;
+
+		static constexpr size_t PRIORITY_COUNT = static_cast< size_t >( TaskPriority::COUNT );
+
+		struct Task
+		{
+			std::function< void() > body;
+			std::shared_ptr< detail::GroupState > group;
+			TaskPriority priority = TaskPriority::NORMAL;
+		};
+
+		struct TaskQueues
+		{
+			std::mutex mutex;
+			std::array< std::deque< Task >, PRIORITY_COUNT > queues;
+			// sizes of the queues, read without the lock to skip empty ones
+			std::array< std::atomic< size_t >, PRIORITY_COUNT > counts {};
+		};
+
+		using clock = std::chrono::steady_clock;
+
+		struct DelayedTask
+		{
+			clock::time_point deadline;
+			Task task;
+
+			bool operator>( const DelayedTask& other ) const
+			{
+				return deadline > other.deadline;
+			}
+		};
+
 		TaskManager();
-		~TaskManager() = default;
+		~TaskManager();
 		TaskManager( const TaskManager& ) = delete;
 		TaskManager& operator = ( const TaskManager& ) = delete;
 
-		BS::thread_pool m_treadPool;
+		void submit( Task task );
+		[[nodiscard]] bool tryRunTask();
+		[[nodiscard]] bool findTask( Task& task );
+		void submitDueTimers();
+		void runTask( Task& task );
+		void workerLoop( size_t index );
+
+		std::vector< std::unique_ptr< TaskQueues > > m_workerQueues;
+		TaskQueues m_sharedQueues;
+		std::vector< std::thread > m_workers;
+
+		std::atomic< size_t > m_queuedTasks { 0 };
+		std::atomic< bool > m_isStopping { false };
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeUp;
+
+		// guarded by m_sleepMutex, the earliest deadline is mirrored for a lock-free check
+		std::vector< DelayedTask > m_timers;
+		std::atomic< clock::rep > m_nextDeadline { clock::time_point::max().time_since_epoch().count() };
 	};
 }
\ No newline at end of file
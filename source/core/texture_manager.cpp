@@ -1,103 +1,193 @@
 #include "texture_manager.hpp"
 
 #include <GLFW/glfw3.h>
-#include <iostream>
-#include <windows.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
-#include "utils/filesystem.hpp"
+#include "common/resources.hpp"
 
+namespace
+{
+	// a pixel between icons keeps linear filtering from bleeding neighbours in
+	constexpr int ATLAS_PADDING = 1;
+	constexpr int ATLAS_MIN_WIDTH = 512;
+	constexpr int CHANNELS = 4;
+	constexpr unsigned char PLACEHOLDER_PIXEL[ CHANNELS ] = { 128, 128, 128, 96 };
+}
 
 core::TextureManager::TextureManager()
 {
+	createPlaceholder();
 	loadAllIcons();
 }
 
 core::TextureManager::~TextureManager()
 {
+	// the decoding tasks write into this object
+	m_decoding.wait();
 	clear();
 }
 
 void core::TextureManager::loadAllIcons()
 {
-	const utils::FileSystem& fs = utils::FileSystem::instance();
-
-	char buffer[ MAX_PATH ];
-	GetModuleFileNameA( NULL, buffer, MAX_PATH );
-	const fs::path exeDir = fs::path( buffer ).parent_path();
-
-	fs::path iconsDir;
-	if ( fs::exists( exeDir / "icons" ) )
+	// the PNGs are compiled in, the known names show the placeholder until the atlas is uploaded
+	const std::span< const common::resources::EmbeddedFile > icons = common::resources::getIcons();
+	for ( const common::resources::EmbeddedFile& icon : icons )
 	{
-		iconsDir = exeDir / "icons";
+		const std::string name( icon.name );
+		m_icons[ name ] = Icon { m_placeholderTexture };
+		m_decodedIcons.push_back( { .name = name, .pixels = {} } );
 	}
-	else
+
+	m_decoding = TaskManager::instance().addTask( [ this, icons ] ()
 	{
-		iconsDir = fs.getProjectSourceDir() / "source/icons";
+		TaskManager::instance().parallelFor( m_decodedIcons.size(), [ & ] ( size_t i )
+		{
+			DecodedIcon& decoded = m_decodedIcons[ i ];
+			const std::span< const unsigned char > png = icons[ i ].data;
+			int channels = 0;
+			unsigned char* data = stbi_load_from_memory( png.data(), static_cast< int >( png.size() ), &decoded.width, &decoded.height, &channels, CHANNELS );
+			if ( !data )
+			{
+				return;
+			}
+
+			decoded.pixels.assign( data, data + static_cast< size_t >( decoded.width ) * decoded.height * CHANNELS );
+			stbi_image_free( data );
+		} );
+
+		// the render loop may be asleep waiting for events
+		glfwPostEmptyEvent();
+	}, TaskPriority::HIGH );
+}
+
+bool core::TextureManager::update()
+{
+	if ( m_isAtlasReady || !m_decoding.isDone() )
+	{
+		return false;
 	}
 
+	buildAtlas();
+	m_isAtlasReady = true;
+	return true;
+}
 
-	if ( !fs::exists( iconsDir ) || !fs::is_directory( iconsDir ) )
+core::Icon core::TextureManager::getIcon( const std::string& name ) const
+{
+	auto it = m_icons.find( name );
+	if ( it == m_icons.end() )
 	{
-		return;
+		return {};
 	}
+	return it->second;
+}
 
-	for ( const auto& icon : fs::directory_iterator( iconsDir ) )
+void core::TextureManager::clear()
+{
+	for ( GLuint texture : { m_atlasTexture, m_placeholderTexture } )
 	{
-		const fs::path iconPath = icon.path();
-		if ( !icon.is_regular_file() || iconPath.extension() != ".png" )
+		if ( texture != 0 )
 		{
-			continue;
+			glDeleteTextures( 1, &texture );
 		}
+	}
+	m_atlasTexture = 0;
+	m_placeholderTexture = 0;
+	m_icons.clear();
+	m_decodedIcons.clear();
+}
+
+void core::TextureManager::createPlaceholder()
+{
+	glGenTextures( 1, &m_placeholderTexture );
+	glBindTexture( GL_TEXTURE_2D, m_placeholderTexture );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_PIXEL );
+}
 
-		const std::string filename = iconPath.stem().string();
-		if ( m_textures.contains( filename ) )
+void core::TextureManager::buildAtlas()
+{
+	// icons that failed to decode are dropped
+	std::erase_if( m_decodedIcons, [ this ] ( const DecodedIcon& decoded )
+	{
+		if ( decoded.pixels.empty() )
 		{
-			continue;
+			m_icons.erase( decoded.name );
+			return true;
 		}
+		return false;
+	} );
+
+	if ( m_decodedIcons.empty() )
+	{
+		return;
+	}
+
+	// shelf packing, the tallest icons first so a shelf wastes little height
+	std::vector< size_t > order( m_decodedIcons.size() );
+	std::iota( order.begin(), order.end(), 0 );
+	std::sort( order.begin(), order.end(), [ this ] ( size_t i1, size_t i2 )
+	{
+		return m_decodedIcons[ i1 ].height > m_decodedIcons[ i2 ].height;
+	} );
 
-		int width = 0;
-		int height = 0;
-		int channels = 0;
-		unsigned char* data = stbi_load( iconPath.string().c_str(), &width, &height, &channels, 4 );
+	int atlasWidth = ATLAS_MIN_WIDTH;
+	for ( const DecodedIcon& decoded : m_decodedIcons )
+	{
+		atlasWidth = std::max( atlasWidth, decoded.width );
+	}
 
-		if ( !data )
+	std::vector< std::pair< int, int > > positions( m_decodedIcons.size() );
+	int posX = 0;
+	int posY = 0;
+	int shelfHeight = 0;
+	for ( size_t i : order )
+	{
+		const DecodedIcon& decoded = m_decodedIcons[ i ];
+		if ( posX + decoded.width > atlasWidth )
 		{
-			continue;
+			posX = 0;
+			posY += shelfHeight + ATLAS_PADDING;
+			shelfHeight = 0;
 		}
 
-		GLuint textureID;
-		glGenTextures( 1, &textureID );
-		glBindTexture( GL_TEXTURE_2D, textureID );
+		positions[ i ] = { posX, posY };
+		posX += decoded.width + ATLAS_PADDING;
+		shelfHeight = std::max( shelfHeight, decoded.height );
+	}
+	const int atlasHeight = posY + shelfHeight;
 
-		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glGenTextures( 1, &m_atlasTexture );
+	glBindTexture( GL_TEXTURE_2D, m_atlasTexture );
 
-		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
 
-		stbi_image_free( data );
+	std::vector< unsigned char > atlas( static_cast< size_t >( atlasWidth ) * atlasHeight * CHANNELS, 0 );
+	for ( size_t i = 0; i < m_decodedIcons.size(); ++i )
+	{
+		const DecodedIcon& decoded = m_decodedIcons[ i ];
+		const auto [ x, y ] = positions[ i ];
+		const size_t rowSize = static_cast< size_t >( decoded.width ) * CHANNELS;
+		for ( int row = 0; row < decoded.height; ++row )
+		{
+			std::memcpy( atlas.data() + ( static_cast< size_t >( y + row ) * atlasWidth + x ) * CHANNELS, decoded.pixels.data() + row * rowSize, rowSize );
+		}
 
-		m_textures[ iconPath.stem().string() ] = textureID;
+		const float width = static_cast< float >( atlasWidth );
+		const float height = static_cast< float >( atlasHeight );
+		m_icons[ decoded.name ] = Icon { m_atlasTexture, x / width, y / height, ( x + decoded.width ) / width, ( y + decoded.height ) / height };
 	}
-}
 
-unsigned int core::TextureManager::getTexture( const std::string& name )
-{
-	auto it = m_textures.find( name );
-	if ( it == m_textures.end() )
-	{
-		return 0;
-	}
-	return it->second;
-}
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, atlasWidth, atlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.data() );
 
-void core::TextureManager::clear()
-{
-	for ( auto& pair : m_textures )
-	{
-		glDeleteTextures( 1, &pair.second );
-	}
-	m_textures.clear();
+	// the pixels live in the atlas now
+	m_decodedIcons.clear();
 }
\ No newline at end of file
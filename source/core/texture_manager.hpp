@@ -2,20 +2,61 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "core/task_manager.hpp"
 
 namespace core
 {
+    // where an icon lies in its texture, the placeholder covers a whole texture
+    struct Icon
+    {
+        unsigned int textureID = 0;
+        float u0 = 0.f;
+        float v0 = 0.f;
+        float u1 = 1.f;
+        float v1 = 1.f;
+
+        bool isValid() const noexcept
+        {
+            return textureID != 0;
+        }
+    };
+
     class TextureManager
     {
     public:
         TextureManager();
         ~TextureManager();
 
+        TextureManager( const TextureManager& ) = delete;
+        TextureManager& operator=( const TextureManager& ) = delete;
+
+        // icons are decoded on the task pool, the first frame does not wait for them
         void loadAllIcons();
-        unsigned int getTexture( const std::string& name );
+        // uploads the atlas on the GL thread once decoding is done. true on the call that replaced the placeholders
+        bool update();
+        // the placeholder while the icons are decoded, an invalid icon when there is no such file
+        [[nodiscard]] Icon getIcon( const std::string& name ) const;
         void clear();
 
     private:
-        std::unordered_map< std::string, unsigned int > m_textures;
+        struct DecodedIcon
+        {
+            std::string name;
+            int width = 0;
+            int height = 0;
+            std::vector< unsigned char > pixels;
+        };
+
+        void createPlaceholder();
+        void buildAtlas();
+
+        std::unordered_map< std::string, Icon > m_icons;
+        std::vector< DecodedIcon > m_decodedIcons;
+        TaskHandle m_decoding;
+        bool m_isAtlasReady = false;
+        unsigned int m_atlasTexture = 0;
+        unsigned int m_placeholderTexture = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,364 @@
+#include "trash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "core/task_manager.hpp"
+#include "utils/filesystem.hpp"
+
+namespace
+{
+	constexpr std::string_view FILES_DIR = "files";
+	constexpr std::string_view INFO_DIR = "info";
+	constexpr std::string_view INFO_EXTENSION = ".trashinfo";
+	constexpr std::string_view DIRECTORY_SIZES = "directorysizes";
+
+	// nothing is ever trashed onto these, a stat on them is wasted
+	constexpr std::array< std::string_view, 14 > VIRTUAL_FILESYSTEMS =
+	{
+		"autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs",
+		"devpts", "fusectl", "mqueue", "proc", "securityfs", "sysfs", "tracefs"
+	};
+
+	struct CachedSize
+	{
+		uint64_t size = 0;
+		int64_t mtime = 0;
+	};
+
+	int hexValue( char c )
+	{
+		if ( c >= '0' && c <= '9' )
+		{
+			return c - '0';
+		}
+		if ( c >= 'a' && c <= 'f' )
+		{
+			return c - 'a' + 10;
+		}
+		if ( c >= 'A' && c <= 'F' )
+		{
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+
+	// directorysizes keeps the names percent-encoded, like the Path key of a .trashinfo
+	std::string decodePercent( std::string_view text )
+	{
+		std::string decoded;
+		decoded.reserve( text.size() );
+		for ( size_t i = 0; i < text.size(); ++i )
+		{
+			const int high = text[ i ] == '%' && i + 2 < text.size() ? hexValue( text[ i + 1 ] ) : -1;
+			const int low = high >= 0 ? hexValue( text[ i + 2 ] ) : -1;
+			if ( low >= 0 )
+			{
+				decoded.push_back( static_cast< char >( high * 16 + low ) );
+				i += 2;
+			}
+			else
+			{
+				decoded.push_back( text[ i ] );
+			}
+		}
+		return decoded;
+	}
+
+	// each line is "size mtime name", the mtime being the one of the .trashinfo of the folder
+	std::optional< std::pair< std::string, CachedSize > > parseSizeLine( const std::string& line )
+	{
+		const size_t sizeEnd = line.find( ' ' );
+		const size_t mtimeEnd = sizeEnd == std::string::npos ? std::string::npos : line.find( ' ', sizeEnd + 1 );
+		if ( mtimeEnd == std::string::npos || mtimeEnd + 1 >= line.size() )
+		{
+			return std::nullopt;
+		}
+
+		try
+		{
+			CachedSize cached;
+			cached.size = std::stoull( line.substr( 0, sizeEnd ) );
+			cached.mtime = std::stoll( line.substr( sizeEnd + 1, mtimeEnd - sizeEnd - 1 ) );
+			return std::make_pair( decodePercent( std::string_view( line ).substr( mtimeEnd + 1 ) ), cached );
+		}
+		catch ( const std::exception& )
+		{
+			return std::nullopt;
+		}
+	}
+
+	std::unordered_map< std::string, CachedSize > readDirectorySizes( const fs::path& trashDir )
+	{
+		std::unordered_map< std::string, CachedSize > sizes;
+		std::ifstream input( trashDir / DIRECTORY_SIZES );
+		std::string line;
+		while ( std::getline( input, line ) )
+		{
+			if ( std::optional< std::pair< std::string, CachedSize > > entry = parseSizeLine( line ) )
+			{
+				sizes.insert( std::move( *entry ) );
+			}
+		}
+		return sizes;
+	}
+
+	// names are read back as bytes, the reverse of utils::pathToString
+	fs::path toPath( const std::string& name )
+	{
+		return fs::path( std::u8string( reinterpret_cast< const char8_t* >( name.data() ), name.size() ) );
+	}
+
+	fs::path getInfoPath( const fs::path& trashDir, const std::string& name )
+	{
+		return trashDir / INFO_DIR / toPath( name + std::string( INFO_EXTENSION ) );
+	}
+
+	std::optional< int64_t > getInfoTime( const fs::path& trashDir, const std::string& name )
+	{
+		std::error_code ec;
+		const fs::file_time_type time = fs::last_write_time( getInfoPath( trashDir, name ), ec );
+		if ( ec )
+		{
+			return std::nullopt;
+		}
+		return std::chrono::duration_cast< std::chrono::seconds >( std::chrono::file_clock::to_sys( time ).time_since_epoch() ).count();
+	}
+
+	uint64_t walkSize( const fs::path& dirPath )
+	{
+		uint64_t size = 0;
+		std::error_code ec;
+		try
+		{
+			for ( const fs::directory_entry& entry : fs::recursive_directory_iterator( dirPath, fs::directory_options::skip_permission_denied, ec ) )
+			{
+				if ( !entry.is_symlink() && entry.is_regular_file() )
+				{
+					size += entry.file_size( ec );
+				}
+			}
+		}
+		catch ( const fs::filesystem_error& ) {}
+		return size;
+	}
+
+	bool isPresent( const fs::path& path )
+	{
+		// a trashed link must not be followed to decide whether it is still there
+		std::error_code ec;
+		return fs::symlink_status( path, ec ).type() != fs::file_type::not_found && !ec;
+	}
+
+#ifndef _WIN32
+	// /proc/self/mounts escapes spaces and other separators as \ooo
+	std::string decodeMountPath( std::string_view text )
+	{
+		std::string decoded;
+		decoded.reserve( text.size() );
+		for ( size_t i = 0; i < text.size(); ++i )
+		{
+			if ( text[ i ] == '\\' && i + 3 < text.size() && text[ i + 1 ] >= '0' && text[ i + 1 ] <= '3' )
+			{
+				decoded.push_back( static_cast< char >( ( text[ i + 1 ] - '0' ) * 64 + ( text[ i + 2 ] - '0' ) * 8 + ( text[ i + 3 ] - '0' ) ) );
+				i += 3;
+			}
+			else
+			{
+				decoded.push_back( text[ i ] );
+			}
+		}
+		return decoded;
+	}
+
+	std::vector< fs::path > readMountPoints()
+	{
+		std::vector< fs::path > mountPoints;
+		std::ifstream input( "/proc/self/mounts" );
+		std::string line;
+		while ( std::getline( input, line ) )
+		{
+			const size_t pathStart = line.find( ' ' );
+			const size_t pathEnd = pathStart == std::string::npos ? std::string::npos : line.find( ' ', pathStart + 1 );
+			const size_t typeEnd = pathEnd == std::string::npos ? std::string::npos : line.find( ' ', pathEnd + 1 );
+			if ( typeEnd == std::string::npos )
+			{
+				continue;
+			}
+
+			const std::string_view type = std::string_view( line ).substr( pathEnd + 1, typeEnd - pathEnd - 1 );
+			if ( std::find( VIRTUAL_FILESYSTEMS.begin(), VIRTUAL_FILESYSTEMS.end(), type ) == VIRTUAL_FILESYSTEMS.end() )
+			{
+				mountPoints.emplace_back( decodeMountPath( std::string_view( line ).substr( pathStart + 1, pathEnd - pathStart - 1 ) ) );
+			}
+		}
+		return mountPoints;
+	}
+
+	// $topdir/.Trash is shared by all users and only trusted when it is a sticky folder, not a link
+	bool isSharedTrash( const fs::path& path )
+	{
+		std::error_code ec;
+		const fs::file_status status = fs::symlink_status( path, ec );
+		return !ec && status.type() == fs::file_type::directory && ( status.permissions() & fs::perms::sticky_bit ) != fs::perms::none;
+	}
+#endif
+}
+
+std::vector< fs::path > core::findTrashDirs()
+{
+	std::vector< fs::path > trashDirs;
+#ifndef _WIN32
+	auto addTrash = [ &trashDirs ] ( const fs::path& path )
+	{
+		std::error_code ec;
+		if ( !fs::is_directory( path / FILES_DIR, ec ) )
+		{
+			return;
+		}
+
+		// bind mounts show the same trash more than once
+		for ( const fs::path& known : trashDirs )
+		{
+			if ( fs::equivalent( known, path, ec ) )
+			{
+				return;
+			}
+		}
+		trashDirs.push_back( path );
+	};
+
+	addTrash( utils::FileSystem::instance().getLocalAppDataDir() / "Trash" );
+
+	const std::string uid = std::to_string( getuid() );
+	for ( const fs::path& mountPoint : readMountPoints() )
+	{
+		if ( isSharedTrash( mountPoint / ".Trash" ) )
+		{
+			addTrash( mountPoint / ".Trash" / uid );
+		}
+		addTrash( mountPoint / ( ".Trash-" + uid ) );
+	}
+#endif
+	return trashDirs;
+}
+
+core::DirInfo core::measureTrash( const fs::path& trashDir )
+{
+	const std::unordered_map< std::string, CachedSize > cachedSizes = readDirectorySizes( trashDir );
+
+	DirInfo info;
+	std::vector< fs::path > uncached;
+	std::error_code ec;
+	try
+	{
+		for ( const fs::directory_entry& entry : fs::directory_iterator( trashDir / FILES_DIR, fs::directory_options::skip_permission_denied, ec ) )
+		{
+			++info.countFile;
+			const fs::file_type type = entry.symlink_status( ec ).type();
+			if ( type != fs::file_type::directory )
+			{
+				info.dirSize += type == fs::file_type::regular ? entry.file_size( ec ) : 0;
+				continue;
+			}
+
+			const std::string name = utils::pathToString( entry.path().filename() );
+			const auto it = cachedSizes.find( name );
+			if ( it != cachedSizes.end() && getInfoTime( trashDir, name ) == it->second.mtime )
+			{
+				info.dirSize += it->second.size;
+			}
+			else
+			{
+				uncached.push_back( entry.path() );
+			}
+		}
+	}
+	catch ( const fs::filesystem_error& ) {}
+
+	std::vector< uint64_t > walkedSizes( uncached.size() );
+	TaskManager::instance().parallelFor( uncached.size(), [ & ] ( size_t i )
+	{
+		walkedSizes[ i ] = walkSize( uncached[ i ] );
+	} );
+
+	for ( const uint64_t size : walkedSizes )
+	{
+		info.dirSize += size;
+	}
+	return info;
+}
+
+std::vector< fs::path > core::listTrashedItems( const fs::path& trashDir )
+{
+	std::vector< fs::path > items;
+	std::error_code ec;
+	try
+	{
+		for ( const fs::directory_entry& entry : fs::directory_iterator( trashDir / FILES_DIR, fs::directory_options::skip_permission_denied, ec ) )
+		{
+			items.push_back( entry.path() );
+		}
+	}
+	catch ( const fs::filesystem_error& ) {}
+	return items;
+}
+
+void core::pruneTrashInfo( const fs::path& trashDir )
+{
+	const fs::path filesDir = trashDir / FILES_DIR;
+	std::error_code ec;
+	try
+	{
+		for ( const fs::directory_entry& entry : fs::directory_iterator( trashDir / INFO_DIR, fs::directory_options::skip_permission_denied, ec ) )
+		{
+			if ( entry.path().extension() == INFO_EXTENSION && !isPresent( filesDir / entry.path().stem() ) )
+			{
+				fs::remove( entry.path(), ec );
+			}
+		}
+	}
+	catch ( const fs::filesystem_error& ) {}
+
+	const fs::path sizesPath = trashDir / DIRECTORY_SIZES;
+	std::vector< std::string > keptLines;
+	{
+		std::ifstream input( sizesPath );
+		std::string line;
+		while ( std::getline( input, line ) )
+		{
+			const std::optional< std::pair< std::string, CachedSize > > entry = parseSizeLine( line );
+			if ( entry && isPresent( filesDir / toPath( entry->first ) ) )
+			{
+				keptLines.push_back( std::move( line ) );
+			}
+		}
+	}
+
+	if ( keptLines.empty() )
+	{
+		fs::remove( sizesPath, ec );
+		return;
+	}
+
+	// other trash users read the cache at any time, so it is replaced in one rename
+	fs::path tempPath = sizesPath;
+	tempPath += ".tmp";
+	{
+		std::ofstream output( tempPath, std::ios::binary | std::ios::trunc );
+		for ( const std::string& line : keptLines )
+		{
+			output << line << '\n';
+		}
+	}
+	fs::rename( tempPath, sizesPath, ec );
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "core/dir_info.hpp"
+
+namespace fs = std::filesystem;
+
+namespace core
+{
+	// freedesktop.org trash folders: the home trash and the .Trash/$uid or .Trash-$uid folders at the top of mounted volumes.
+	// empty on Windows, where the recycle bin is reached through the shell
+	[[nodiscard]] std::vector< fs::path > findTrashDirs();
+
+	// counts the trashed items, not the files inside them. folder sizes come from the directorysizes cache while
+	// it matches the .trashinfo of the folder, only the folders missing from it are walked
+	[[nodiscard]] DirInfo measureTrash( const fs::path& trashDir );
+
+	// the trashed items under files/
+	[[nodiscard]] std::vector< fs::path > listTrashedItems( const fs::path& trashDir );
+
+	// drops the .trashinfo and directorysizes entries of the items that are gone
+	void pruneTrashInfo( const fs::path& trashDir );
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <imgui.h>
 
+#include "common/resources.hpp"
 #include "core/window.hpp"
 
 gui::Gui::Gui( core::Window& window ) : 
@@ -25,6 +26,21 @@ void gui::Gui::render()
 	ImGui::End();
 }
 
+bool gui::Gui::isBusy()
+{
+	return m_cleanerPanel.isBusy();
+}
+
+bool gui::Gui::isInteractive() const
+{
+	return m_cleanerPanel.isInteractive();
+}
+
+void gui::Gui::setStartupTimes( float firstFrameMs, float interactiveMs )
+{
+	m_titleBar.setStartupTimes( firstFrameMs, interactiveMs );
+}
+
 void gui::Gui::initStyle()
 {
 	ImGui::StyleColorsDark();
@@ -34,6 +50,11 @@ void gui::Gui::initStyle()
 	style.Colors[ ImGuiCol_TabSelected ] = style.Colors[ ImGuiCol_TableBorderLight ];
 	style.Colors[ ImGuiCol_TabHovered ] = style.Colors[ ImGuiCol_TableBorderLight ];
 
+	// the font is embedded in the binary, the atlas must not free it
+	const std::span< const unsigned char > fontData = common::resources::getFont();
+	ImFontConfig fontConfig;
+	fontConfig.FontDataOwnedByAtlas = false;
+
 	ImGuiIO& io = ImGui::GetIO(); 
-	ImFont* font = io.Fonts->AddFontFromFileTTF( "C:/Windows/Fonts/arial.ttf", 14.0f, nullptr, io.Fonts->GetGlyphRangesCyrillic() );
+	io.Fonts->AddFontFromMemoryTTF( const_cast< unsigned char* >( fontData.data() ), static_cast< int >( fontData.size() ), 14.0f, &fontConfig, io.Fonts->GetGlyphRangesCyrillic() );
 }
\ No newline at end of file
@@ -18,6 +18,9 @@ namespace gui
 		Gui( core::Window& window );
 
 		void render();
+		bool isBusy();
+		bool isInteractive() const;
+		void setStartupTimes( float firstFrameMs, float interactiveMs );
 
 	private:
 		void initStyle();
@@ -2,10 +2,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <ranges>
 #include <string>
 
 #include <imgui.h>
+#include <GLFW/glfw3.h>
 
 #include "common/constants.hpp"
 #include "common/scoped_guards.hpp"
@@ -21,6 +23,8 @@ namespace
 	constexpr float MEGABYTE = KILOBYTE * KILOBYTE;
 	constexpr ImVec2 SMALL_ICON_SIZE = ImVec2( 16.f, 16.f );
 	constexpr ImVec2 BIG_ICON_SIZE = ImVec2( 24.f, 24.f );
+	constexpr size_t GROWTH_TOOLTIP_LINES = 10;
+	constexpr size_t MAX_REPORTED_IMPORT_ERRORS = 10;
 
 	constexpr ImU32 GREEN_COLOR = IM_COL32( 0, 200, 0, 255 );
 
@@ -34,27 +38,49 @@ namespace
 		return result;
 	}
 
-	inline void rightAlignedText( const std::string& text )
+	inline void rightAlignedText( const std::string& text, float textWidth )
 	{
 		const float regionAvail = ImGui::GetContentRegionAvail().x;
-		const float textSize = ImGui::CalcTextSize( text.c_str() ).x;
-		ImGui::SetCursorPosX( ImGui::GetCursorPosX() + regionAvail - textSize );
-		ImGui::Text( text.c_str() );
+		ImGui::SetCursorPosX( ImGui::GetCursorPosX() + regionAvail - textWidth );
+		ImGui::TextUnformatted( text.c_str() );
 	}
 }
 
 gui::CleanerPanel::CleanerPanel()
 {
-	m_cleaningItems = m_systemCleaner.collectCleaningItems();
-	for ( common::CleaningItem& cleanTarget : m_cleaningItems )
+	// wakes the render loop, which sleeps in glfwWaitEventsTimeout while nothing happens
+	m_systemCleaner.setChangeListener( [] ()
 	{
-		cleanTarget.textureID = m_textureManager.getTexture( cleanTarget.name );
-	}
+		glfwPostEmptyEvent();
+	} );
+
+	m_cleaningItems = m_systemCleaner.collectCleaningItems();
 	m_customIndex = m_cleaningItems.size() - 1;
 }
 
 void gui::CleanerPanel::draw()
 {
+	// checked first, so whatever finished before it is taken below
+	const bool isStartupDone = m_systemCleaner.isStartupDone();
+	applyDiscoveredItems();
+	applyImportResults();
+	if ( const std::optional< size_t > restored = m_systemCleaner.takeRestoredCount() )
+	{
+		utils::openMessageBox( "Undo", "Restored " + std::to_string( *restored ) + " options", utils::ButtonFlag::BUTTON_OK, utils::BoxType::TYPE_INFO );
+	}
+	m_isStartupApplied = m_isStartupApplied || isStartupDone;
+
+	if ( m_textureManager.update() )
+	{
+		m_viewModel.markDirty();
+		assignResultIcons();
+	}
+
+	if ( m_viewModel.isDirty() )
+	{
+		m_viewModel.rebuild( m_cleaningItems, m_systemCleaner, m_textureManager );
+	}
+
 	ImGui::StyleGuard styleGuard( ImGuiCol_ChildBg, IM_COL32( 100, 100, 100, 255 ) );
 	
 	ImGui::Child cleanerPanel( "Cleaner panel" );
@@ -84,6 +110,17 @@ void gui::CleanerPanel::draw()
 	}
 }
 
+bool gui::CleanerPanel::isInteractive() const
+{
+	return m_isStartupApplied;
+}
+
+bool gui::CleanerPanel::isBusy()
+{
+	const common::CleanerState state = m_systemCleaner.getCurrentState();
+	return state == common::CleanerState::ANALYZING || state == common::CleanerState::CLEANING;
+}
+
 void gui::CleanerPanel::drawTabBar()
 {
 	if ( ImGui::BeginTabBar( "CleanerTabs" ) )
@@ -138,11 +175,27 @@ void gui::CleanerPanel::drawMain()
 		m_systemCleaner.analysis( m_cleaningItems );
 	}
 
+	ImGui::SameLine( ( contentAvail.x - buttonSize.x ) * 0.5f );
+	if ( ImGui::Button( "Duplicates", buttonSize ) )
+	{
+		m_cleanSummary.reset();
+		m_systemCleaner.findDuplicates( m_cleaningItems );
+	}
+	utils::Tooltip( "Find identical files in the enabled items" );
+
+	const ImGuiStyle& style = ImGui::GetStyle();
+	const float checkboxWidth = ImGui::GetFrameHeight() + style.ItemInnerSpacing.x + ImGui::CalcTextSize( "Undoable" ).x;
+	ImGui::SameLine( contentAvail.x - buttonSize.x - style.ItemSpacing.x - checkboxWidth );
+	ImGui::SetCursorPosY( buttonPosY + ( BUTTON_HEIGHT - ImGui::GetFrameHeight() ) * 0.5f );
+	ImGui::Checkbox( "Undoable", &m_isUndoableClear );
+	utils::Tooltip( "Move the files aside at once and delete them in the background, the clear can be undone for a few minutes" );
+
 	ImGui::SameLine( contentAvail.x - buttonSize.x );
+	ImGui::SetCursorPosY( buttonPosY );
 	if ( ImGui::Button( "Clear", buttonSize ) )
 	{
 		m_cleanSummary.reset();
-		m_systemCleaner.clear( m_cleaningItems );
+		m_systemCleaner.clear( m_cleaningItems, m_isUndoableClear ? core::ClearMode::QUARANTINE : core::ClearMode::DELETE );
 	}	
 }
 
@@ -150,28 +203,23 @@ void gui::CleanerPanel::drawBulkCheckboxButtons()
 {
 	auto toggleAllOptions = [ this ]( bool enable )
 	{
-		for ( common::CleaningItem& cleanItem : m_cleaningItems )
+		for ( size_t itemIndex : m_viewModel.getVisibleItems( m_activeContext ) )
 		{
-			if ( !isItemVisible( cleanItem ) )
-			{
-				continue;
-			}
-
-			for ( common::CleanOption& cleanOption : cleanItem.cleanOptions )
+			for ( common::CleanOption& cleanOption : m_cleaningItems[ itemIndex ].cleanOptions )
 			{
 				cleanOption.enabled = enable;
 			}
 		}
 	};
 
-	if ( ImGui::ImageButton( "Enable all visible items", m_textureManager.getTexture( "Enable All" ), BIG_ICON_SIZE ) )
+	if ( utils::IconButton( "Enable all visible items", m_viewModel.getIcons().enableAll, BIG_ICON_SIZE ) )
 	{
 		toggleAllOptions( true );
 	}
 	utils::Tooltip( "Enable all visible items" );
 
 	ImGui::SameLine();
-	if ( ImGui::ImageButton( "Disable all visible items", m_textureManager.getTexture( "Disable All" ), BIG_ICON_SIZE ) )
+	if ( utils::IconButton( "Disable all visible items", m_viewModel.getIcons().disableAll, BIG_ICON_SIZE ) )
 	{
 		toggleAllOptions( false );
 	}
@@ -180,13 +228,9 @@ void gui::CleanerPanel::drawBulkCheckboxButtons()
 
 void gui::CleanerPanel::drawCleaningItems()
 {
-	for ( common::CleaningItem& cleanItem : m_cleaningItems )
+	for ( size_t itemIndex : m_viewModel.getVisibleItems( m_activeContext ) )
 	{
-		if ( !isItemVisible( cleanItem ) )
-		{
-			continue;
-		}
-
+		common::CleaningItem& cleanItem = m_cleaningItems[ itemIndex ];
 		const bool isCustomItem = cleanItem.itemType == common::ItemType::CUSTOM_PATH;
 		if ( isCustomItem )
 		{
@@ -194,7 +238,7 @@ void gui::CleanerPanel::drawCleaningItems()
 		}
 		else
 		{
-			drawOptions( cleanItem );
+			drawOptions( cleanItem, m_viewModel.getItemIcon( itemIndex ) );
 		}
 	}
 }
@@ -209,6 +253,7 @@ void gui::CleanerPanel::drawCustomPathsMenu()
 			if ( result.isSuccess() )
 			{
 				m_cleaningItems[ m_customIndex ].cleanOptions.push_back( std::move( result.option ) );
+				m_viewModel.markDirty();
 			}
 			else
 			{
@@ -217,7 +262,7 @@ void gui::CleanerPanel::drawCustomPathsMenu()
 		}
 	};
 
-	if ( ImGui::ImageButton( "Custom file", m_textureManager.getTexture( "Add File" ), BIG_ICON_SIZE ) )
+	if ( utils::IconButton( "Custom file", m_viewModel.getIcons().addFile, BIG_ICON_SIZE ) )
 	{
 		common::OptionalPath path = utils::openFileDialog();
 		processingPath( path );
@@ -225,7 +270,7 @@ void gui::CleanerPanel::drawCustomPathsMenu()
 	utils::Tooltip( "Add file path" );
 
 	ImGui::SameLine();
-	if ( ImGui::ImageButton( "Custom folder", m_textureManager.getTexture( "Add Folder" ), BIG_ICON_SIZE ) )
+	if ( utils::IconButton( "Custom folder", m_viewModel.getIcons().addFolder, BIG_ICON_SIZE ) )
 	{
 		common::OptionalPath path = utils::openFolderDialog();
 		processingPath( path );
@@ -233,7 +278,18 @@ void gui::CleanerPanel::drawCustomPathsMenu()
 	utils::Tooltip( "Add folder path" );
 
 	ImGui::SameLine();
-	if ( ImGui::ImageButton( "Remove custom paths", m_textureManager.getTexture( "Remove" ), BIG_ICON_SIZE ) )
+	const ImVec2 importButtonSize( 0.f, BIG_ICON_SIZE.y + ImGui::GetStyle().FramePadding.y * 2 );
+	if ( ImGui::Button( "Import", importButtonSize ) )
+	{
+		if ( common::OptionalPath listPath = utils::openPathListDialog(); listPath.has_value() )
+		{
+			m_systemCleaner.importCustomPathList( listPath.value() );
+		}
+	}
+	utils::Tooltip( "Import paths and patterns from a list file" );
+
+	ImGui::SameLine();
+	if ( utils::IconButton( "Remove custom paths", m_viewModel.getIcons().remove, BIG_ICON_SIZE ) )
 	{
 		if ( !m_cleaningItems[ m_customIndex ].cleanOptions.empty() )
 		{
@@ -252,6 +308,7 @@ void gui::CleanerPanel::drawCustomPathsMenu()
 					}
 					return false;
 				} ), options.end() );
+				m_viewModel.markDirty();
 			}
 		}
 	}
@@ -269,19 +326,18 @@ void gui::CleanerPanel::drawCleaningItemsHeader()
 	}
 }
 
-void gui::CleanerPanel::drawOptions( common::CleaningItem& cleaningItem )
+void gui::CleanerPanel::drawOptions( common::CleaningItem& cleaningItem, const core::Icon& icon )
 {
 	ImGui::IDGuard guard( cleaningItem.name );
-	const unsigned int textureId = m_textureManager.getTexture( cleaningItem.name );
-	if ( textureId != ImTextureID_Invalid )
+	if ( icon.isValid() )
 	{
-		ImGui::Image( textureId, SMALL_ICON_SIZE );
+		utils::IconImage( icon, SMALL_ICON_SIZE );
 		ImGui::SameLine();
 	}
 
 	const float checkboxOffset = ImGui::GetCursorPosX();
 	ImGui::AlignTextToFramePadding();
-	ImGui::Text( cleaningItem.name.c_str() );
+	ImGui::TextUnformatted( cleaningItem.name.c_str() );
 	{
 		ImGui::IndentGuard indent( checkboxOffset );
 		for ( common::CleanOption& cleanOption : cleaningItem.cleanOptions )
@@ -294,15 +350,15 @@ void gui::CleanerPanel::drawOptions( common::CleaningItem& cleaningItem )
 void gui::CleanerPanel::drawCustomOptions( common::CleaningItem& cleaningItem )
 {
 	std::vector< common::CleanOption >& cleanOptions = cleaningItem.cleanOptions;
-	for ( auto& [ enabled, displayName, id ] : cleanOptions )
+	for ( size_t i = 0; i < cleanOptions.size(); ++i )
 	{
+		auto& [ enabled, displayName, id ] = cleanOptions[ i ];
 		ImGui::IDGuard guard( id );
 
-		ImGui::Checkbox( displayName.c_str(), &enabled);
-		const common::OptionalString fullPath = m_systemCleaner.getFullPath( id );
-		if ( fullPath.has_value() && !fullPath.value().empty() )
+		ImGui::Checkbox( displayName.c_str(), &enabled );
+		if ( const std::string& fullPath = m_viewModel.getCustomTooltip( i ); !fullPath.empty() )
 		{
-			utils::Tooltip( fullPath.value().c_str() );
+			utils::Tooltip( fullPath.c_str() );
 		}
 	}
 
@@ -313,6 +369,7 @@ void gui::CleanerPanel::drawCustomOptions( common::CleaningItem& cleaningItem )
 		{
 			return opt.enabled;
 		} ), cleanOptions.end() );
+		m_viewModel.markDirty();
 	}
 }
 
@@ -327,15 +384,53 @@ void gui::CleanerPanel::drawResultCleaningOrAnalysis()
 {
 	{
 		const bool isSummaryAnalysis = m_cleanSummary.type == common::SummaryType::ANALYSIS;
+		const bool isSummaryDuplicates = m_cleanSummary.type == common::SummaryType::DUPLICATES;
 
 		ImGui::IndentGuard indent( 10.f );
-		ImGui::Text( isSummaryAnalysis ? "Analysis completed" : "Cleaning is complete" );
+		ImGui::Text( isSummaryDuplicates ? "Duplicate search completed" : isSummaryAnalysis ? "Analysis completed" : "Cleaning is complete" );
 		ImGui::SameLine();
 		ImGui::Text( "(%.3fs)", m_cleanSummary.totalTime );
+		if ( const common::ConcurrencyStats& concurrency = m_cleanSummary.concurrency; concurrency.peakWorkers > 0 )
+		{
+			char statsText[ 160 ];
+			std::snprintf( statsText, sizeof( statsText ), "Workers: peak %zu, final %zu (%u raises, %u cuts)\nPeak throughput: %.0f files/s",
+				concurrency.peakWorkers, concurrency.finalWorkers, concurrency.increases, concurrency.decreases, concurrency.peakOpsPerSecond );
+			utils::Tooltip( statsText );
+		}
 
-		ImGui::Text( isSummaryAnalysis ? "Will be cleared approximately:" : "Cleared:" );
+		ImGui::Text( isSummaryDuplicates ? "Can be reclaimed:" : isSummaryAnalysis ? "Will be cleared approximately:" : "Cleared:" );
 		ImGui::SameLine();
 		ImGui::Text( "%.2f MB", static_cast< float >( m_cleanSummary.totalSize ) / MEGABYTE );
+
+		if ( m_cleanSummary.type == common::SummaryType::CLEANING && m_cleanSummary.removedDirs > 0 )
+		{
+			ImGui::Text( "Removed empty folders: %llu", static_cast< unsigned long long >( m_cleanSummary.removedDirs ) );
+		}
+
+		if ( m_cleanSummary.type == common::SummaryType::CLEANING && m_systemCleaner.canUndoClear() )
+		{
+			if ( ImGui::Button( "Undo" ) )
+			{
+				m_systemCleaner.undoClear();
+				m_cleanSummary.reset();
+			}
+			utils::Tooltip( "Put the cleared files back, possible until they are deleted in the background" );
+		}
+
+		if ( m_cleanSummary.type == common::SummaryType::CLEANING && m_cleanSummary.pinnedFiles > 0 )
+		{
+			ImGui::Text( "Held open by running programs: %.2f MB", static_cast< float >( m_cleanSummary.pinnedSize ) / MEGABYTE );
+			utils::Tooltip( "These files are in use and were left in place, close the programs using them and clean again" );
+		}
+
+		if ( isSummaryAnalysis && m_scanDiff.hasPrevious )
+		{
+			ImGui::Text( "Grown since last run: %+.2f MB", static_cast< float >( m_scanDiff.totalSizeDelta ) / MEGABYTE );
+			if ( !m_growthTooltip.empty() )
+			{
+				utils::Tooltip( m_growthTooltip.c_str() );
+			}
+		}
 	}
 
 	ImGui::Spacing();
@@ -343,35 +438,62 @@ void gui::CleanerPanel::drawResultCleaningOrAnalysis()
 
 	const ImVec2 contentAvail = ImGui::GetContentRegionAvail();
 	const float childHieght = contentAvail.y - BUTTON_HEIGHT - VERTICAL_OFFSET * 2;
-	ImGui::Child result( "ResultCleaningOrAnalysis", ImVec2( 0, childHieght ) );
-	
-	constexpr ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
-	if ( auto table = ImGui::Table( "CleanSummaryTable", 3, flags ) )
+
+	// duplicate groups keep their own sort order, they are ranked by reclaimable size
+	const bool isDuplicates = m_cleanSummary.type == common::SummaryType::DUPLICATES;
+	constexpr ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Sortable;
+	if ( auto table = ImGui::Table( isDuplicates ? "DuplicatesTable" : "CleanSummaryTable", 3, flags, ImVec2( 0, childHieght ) ) )
 	{
-		constexpr ImGuiTableColumnFlags columnFlags = ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_WidthFixed;
-		ImGui::TableSetupColumn( "##name", columnFlags, contentAvail.x * 0.5 );
-		ImGui::TableSetupColumn( "##cleanedSize", columnFlags, contentAvail.x * 0.30 );
-		ImGui::TableSetupColumn( "##cleanedFiles", columnFlags, contentAvail.x * 0.20 );
+		constexpr ImGuiTableColumnFlags columnFlags = ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_WidthStretch;
+		constexpr ImGuiTableColumnFlags sizeFlags = columnFlags | ImGuiTableColumnFlags_PreferSortDescending;
+		ImGui::TableSetupColumn( "Name", columnFlags | ( isDuplicates ? 0 : ImGuiTableColumnFlags_DefaultSort ), 0.5f, ResultColumn::NAME );
+		ImGui::TableSetupColumn( "Size", sizeFlags | ( isDuplicates ? ImGuiTableColumnFlags_DefaultSort : 0 ), 0.3f, ResultColumn::SIZE );
+		ImGui::TableSetupColumn( "Files", sizeFlags, 0.2f, ResultColumn::FILES );
+		ImGui::TableSetupScrollFreeze( 0, 1 );
+		ImGui::TableHeadersRow();
+
+		if ( ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && ( sortSpecs->SpecsDirty || m_isResultOrderDirty ) )
+		{
+			sortResultRows( *sortSpecs );
+			sortSpecs->SpecsDirty = false;
+			m_isResultOrderDirty = false;
+		}
 
-		for ( const auto& result : m_cleanSummary.results )
+		// only the visible rows are submitted, the strings were formatted when the results arrived
+		ImGuiListClipper clipper;
+		clipper.Begin( static_cast< int >( m_resultRows.size() ) );
+		while ( clipper.Step() )
 		{
-			ImGui::TableNextRow();
-			ImGui::TableNextColumn();
-			
-			if ( result.textureID != ImTextureID_Invalid )
+			for ( int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row )
 			{
-				ImGui::Image( result.textureID, SMALL_ICON_SIZE );
-				ImGui::SameLine();
-			}
-			ImGui::Text( "%s - %s", result.propertyName.c_str(), result.categoryName.c_str() );
+				const ResultRow& resultRow = m_resultRows[ row ];
+				const common::CleanResult& result = m_cleanSummary.results[ resultRow.resultIndex ];
+
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+
+				if ( resultRow.icon.isValid() )
+				{
+					utils::IconImage( resultRow.icon, SMALL_ICON_SIZE );
+					ImGui::SameLine();
+				}
+				ImGui::TextUnformatted( resultRow.label.c_str() );
+				if ( !result.paths.empty() && ImGui::IsItemHovered() )
+				{
+					ImGui::BeginTooltip();
+					for ( const std::string& path : result.paths )
+					{
+						ImGui::TextUnformatted( path.c_str() );
+					}
+					ImGui::EndTooltip();
+				}
 
-			ImGui::TableNextColumn();
-			const std::string cleanedSize = std::to_string( static_cast< int >( std::ceil( result.cleanedSize / KILOBYTE ) ) );
-			rightAlignedText( separateString( cleanedSize ) + " KB" );
+				ImGui::TableNextColumn();
+				rightAlignedText( resultRow.sizeText, resultRow.sizeWidth );
 
-			ImGui::TableNextColumn();
-			const std::string cleanedFiles = separateString( std::to_string( result.cleanedFiles ) );
-			rightAlignedText( cleanedFiles );
+				ImGui::TableNextColumn();
+				rightAlignedText( resultRow.filesText, resultRow.filesWidth );
+			}
 		}
 	}
 }
@@ -380,31 +502,153 @@ void gui::CleanerPanel::prepareResultsForDisplay()
 {
 	m_cleanSummary = m_systemCleaner.getSummary();
 
-	// sort results
-	std::vector< common::CleanResult >& results = m_cleanSummary.results;
-	std::sort( results.begin(), results.end(),
-	[] ( const common::CleanResult& r1, const common::CleanResult& r2 )
+	// format the rows once, the order is applied by the table's sort specs
+	m_resultRows.clear();
+	m_resultRows.reserve( m_cleanSummary.results.size() );
+	for ( size_t i = 0; i < m_cleanSummary.results.size(); ++i )
+	{
+		const common::CleanResult& result = m_cleanSummary.results[ i ];
+		ResultRow row;
+		row.resultIndex = i;
+		row.label = result.propertyName + " - " + result.categoryName;
+		row.sizeText = separateString( std::to_string( static_cast< uint64_t >( std::ceil( result.cleanedSize / KILOBYTE ) ) ) ) + " KB";
+		row.filesText = separateString( std::to_string( result.cleanedFiles ) );
+		row.sizeWidth = ImGui::CalcTextSize( row.sizeText.c_str() ).x;
+		row.filesWidth = ImGui::CalcTextSize( row.filesText.c_str() ).x;
+		m_resultRows.push_back( std::move( row ) );
+	}
+	assignResultIcons();
+	m_isResultOrderDirty = true;
+
+	m_scanDiff = m_systemCleaner.getScanDiff();
+	m_growthTooltip.clear();
+	for ( const core::GrowthEntry& growth : m_scanDiff.options | std::views::take( GROWTH_TOOLTIP_LINES ) )
+	{
+		char line[ 64 ];
+		std::snprintf( line, sizeof( line ), "%+.2f MB  ", static_cast< float >( growth.sizeDelta ) / MEGABYTE );
+		m_growthTooltip += line + growth.option + "\n";
+	}
+}
+
+void gui::CleanerPanel::sortResultRows( const ImGuiTableSortSpecs& sortSpecs )
+{
+	if ( sortSpecs.SpecsCount == 0 )
+	{
+		return;
+	}
+
+	const ImGuiTableColumnSortSpecs& spec = sortSpecs.Specs[ 0 ];
+	const bool isAscending = spec.SortDirection == ImGuiSortDirection_Ascending;
+	const std::vector< common::CleanResult >& results = m_cleanSummary.results;
+	std::sort( m_resultRows.begin(), m_resultRows.end(), [ & ] ( const ResultRow& r1, const ResultRow& r2 )
 	{
-		return r1.propertyName < r2.propertyName;
+		const common::CleanResult& result1 = results[ r1.resultIndex ];
+		const common::CleanResult& result2 = results[ r2.resultIndex ];
+		int order = 0;
+		switch ( spec.ColumnUserID )
+		{
+			case ResultColumn::NAME:
+				order = r1.label.compare( r2.label );
+				break;
+			case ResultColumn::SIZE:
+				order = result1.cleanedSize < result2.cleanedSize ? -1 : result1.cleanedSize > result2.cleanedSize;
+				break;
+			case ResultColumn::FILES:
+				order = result1.cleanedFiles < result2.cleanedFiles ? -1 : result1.cleanedFiles > result2.cleanedFiles;
+				break;
+		}
+
+		// equal rows keep the order they arrived in
+		if ( order == 0 )
+		{
+			return r1.resultIndex < r2.resultIndex;
+		}
+		return isAscending ? order < 0 : order > 0;
 	} );
+}
+
+void gui::CleanerPanel::assignResultIcons()
+{
+	for ( ResultRow& row : m_resultRows )
+	{
+		row.icon = m_textureManager.getIcon( m_cleanSummary.results[ row.resultIndex ].propertyName );
+	}
+}
 
-	// assign icons
-	for ( auto& result : m_cleanSummary.results )
+void gui::CleanerPanel::applyDiscoveredItems()
+{
+	common::DiscoveredItems discovered = m_systemCleaner.takeDiscoveredItems();
+	if ( discovered.isTargetsReload )
 	{
-		result.textureID = m_textureManager.getTexture( result.propertyName );
+		std::erase_if( m_cleaningItems, [] ( const common::CleaningItem& item )
+		{
+			return item.isConfigured;
+		} );
+		m_customIndex = m_cleaningItems.size() - 1;
+		m_viewModel.markDirty();
 	}
+
+	if ( !discovered.targetErrors.empty() )
+	{
+		std::string message;
+		for ( size_t i = 0; i < std::min( discovered.targetErrors.size(), MAX_REPORTED_IMPORT_ERRORS ); ++i )
+		{
+			message += discovered.targetErrors[ i ] + "\n";
+		}
+		if ( discovered.targetErrors.size() > MAX_REPORTED_IMPORT_ERRORS )
+		{
+			message += "...";
+		}
+		utils::openMessageBox( "targets.ini", message, utils::ButtonFlag::BUTTON_OK, utils::BoxType::TYPE_WARNING );
+	}
+
+	if ( discovered.items.empty() )
+	{
+		return;
+	}
+
+	// custom paths stay the last item
+	m_cleaningItems.insert( m_cleaningItems.begin() + m_customIndex,
+		std::make_move_iterator( discovered.items.begin() ), std::make_move_iterator( discovered.items.end() ) );
+	m_customIndex = m_cleaningItems.size() - 1;
+	m_viewModel.markDirty();
 }
 
-bool gui::CleanerPanel::isItemVisible( const common::CleaningItem& item ) const
+void gui::CleanerPanel::applyImportResults()
 {
-	switch ( m_activeContext )
+	for ( common::ImportResult& importResult : m_systemCleaner.takeImportResults() )
 	{
-		case ActiveContext::BROWSER:
-			return item.itemType == common::ItemType::BROWSER;
-		case ActiveContext::TEMP_AND_SYSTEM:
-			return item.itemType == common::ItemType::TEMP || item.itemType == common::ItemType::SYSTEM;
-		case ActiveContext::CUSTOM:
-			return item.itemType == common::ItemType::CUSTOM_PATH;
+		std::vector< common::CleanOption >& options = m_cleaningItems[ m_customIndex ].cleanOptions;
+		m_viewModel.markDirty();
+		std::string errors;
+		size_t countErrors = 0;
+		for ( common::PathImportEntry& entry : importResult.entries )
+		{
+			if ( entry.result.isSuccess() )
+			{
+				options.push_back( std::move( entry.result.option ) );
+			}
+			else if ( ++countErrors <= MAX_REPORTED_IMPORT_ERRORS )
+			{
+				errors += entry.path + ": " + entry.result.errorMessage + "\n";
+			}
+		}
+
+		if ( importResult.isRestore )
+		{
+			continue;
+		}
+
+		std::string message = "Imported " + std::to_string( importResult.countAdded() ) +
+			" of " + std::to_string( importResult.entries.size() ) + " paths";
+		if ( countErrors > 0 )
+		{
+			message += "\n\n" + errors;
+			if ( countErrors > MAX_REPORTED_IMPORT_ERRORS )
+			{
+				message += "...";
+			}
+		}
+		utils::openMessageBox( "Import", message, utils::ButtonFlag::BUTTON_OK, countErrors > 0 ? utils::BoxType::TYPE_WARNING : utils::BoxType::TYPE_INFO );
 	}
-	return false;
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 #pragma execution_character_set("utf-8")
 
 #include <memory>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
 
 #include "common/cleaner_info.hpp"
 #include "common/types.hpp"
@@ -9,13 +13,28 @@
 #include "core/system_cleaner.hpp"
 #include "core/texture_manager.hpp"
 
+#include "cleaner_view_model.hpp"
+
 namespace gui
 {
-	enum class ActiveContext : size_t
+	// user ids of the result table columns, used by the sort specs
+	enum ResultColumn : ImGuiID
+	{
+		NAME,
+		SIZE,
+		FILES
+	};
+
+	// a result formatted once when the results arrive, the table only draws the visible rows
+	struct ResultRow
 	{
-		BROWSER,
-		TEMP_AND_SYSTEM,
-		CUSTOM
+		size_t resultIndex = 0;
+		core::Icon icon;
+		std::string label;
+		std::string sizeText;
+		std::string filesText;
+		float sizeWidth = 0.f;
+		float filesWidth = 0.f;
 	};
 
 	class CleanerPanel
@@ -24,6 +43,10 @@ namespace gui
 		CleanerPanel();
 
 		void draw();
+		// every startup section has been applied to the items
+		bool isInteractive() const;
+		// a run is going on and the progress has to be redrawn
+		bool isBusy();
 
 	private:
 		void drawTabBar();
@@ -34,22 +57,32 @@ namespace gui
 		void drawCleaningItemsHeader();
 
 		void drawCleaningItems();
-		void drawOptions( common::CleaningItem& cleaningItem );
+		void drawOptions( common::CleaningItem& cleaningItem, const core::Icon& icon );
 		void drawCustomOptions( common::CleaningItem& cleaningItem );
 		void drawProgress();
 		void drawResultCleaningOrAnalysis();
 
 		void prepareResultsForDisplay();
-
-		bool isItemVisible( const common::CleaningItem& item ) const;
+		void sortResultRows( const ImGuiTableSortSpecs& sortSpecs );
+		void assignResultIcons();
+		void applyDiscoveredItems();
+		void applyImportResults();
 
 		core::SystemCleaner m_systemCleaner;
 		common::CleaningItems m_cleaningItems;
 		size_t m_customIndex;
 		common::Summary m_cleanSummary;
+		std::vector< ResultRow > m_resultRows;
+		bool m_isResultOrderDirty = false;
+		bool m_isStartupApplied = false;
+		// clear renames the options aside, so it can be undone until the background purge
+		bool m_isUndoableClear = false;
+		core::ScanDiff m_scanDiff;
+		std::string m_growthTooltip;
 
 		ActiveContext m_activeContext = ActiveContext::TEMP_AND_SYSTEM;
 
 		core::TextureManager m_textureManager;
+		CleanerViewModel m_viewModel;
 	};
 }
\ No newline at end of file
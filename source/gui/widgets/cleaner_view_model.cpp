@@ -0,0 +1,97 @@
+#include "cleaner_view_model.hpp"
+
+#include "core/system_cleaner.hpp"
+#include "core/texture_manager.hpp"
+
+namespace
+{
+	const std::string EMPTY_TOOLTIP;
+}
+
+void gui::CleanerViewModel::rebuild( const common::CleaningItems& cleaningItems, core::SystemCleaner& systemCleaner, core::TextureManager& textureManager )
+{
+	m_icons.enableAll = textureManager.getIcon( "Enable All" );
+	m_icons.disableAll = textureManager.getIcon( "Disable All" );
+	m_icons.addFile = textureManager.getIcon( "Add File" );
+	m_icons.addFolder = textureManager.getIcon( "Add Folder" );
+	m_icons.remove = textureManager.getIcon( "Remove" );
+
+	for ( std::vector< size_t >& visibleItems : m_visibleItems )
+	{
+		visibleItems.clear();
+	}
+	m_itemIcons.clear();
+	m_customTooltips.clear();
+
+	for ( size_t i = 0; i < cleaningItems.size(); ++i )
+	{
+		const common::CleaningItem& cleaningItem = cleaningItems[ i ];
+		m_itemIcons.push_back( textureManager.getIcon( cleaningItem.name ) );
+
+		for ( size_t context = 0; context < m_visibleItems.size(); ++context )
+		{
+			if ( isVisibleIn( cleaningItem, static_cast< ActiveContext >( context ) ) )
+			{
+				m_visibleItems[ context ].push_back( i );
+			}
+		}
+
+		if ( cleaningItem.itemType != common::ItemType::CUSTOM_PATH )
+		{
+			continue;
+		}
+
+		m_customTooltips.reserve( cleaningItem.cleanOptions.size() );
+		for ( const common::CleanOption& cleanOption : cleaningItem.cleanOptions )
+		{
+			m_customTooltips.push_back( systemCleaner.getFullPath( cleanOption.id ).value_or( "" ) );
+		}
+	}
+
+	m_isDirty = false;
+}
+
+void gui::CleanerViewModel::markDirty() noexcept
+{
+	m_isDirty = true;
+}
+
+bool gui::CleanerViewModel::isDirty() const noexcept
+{
+	return m_isDirty;
+}
+
+const std::vector< size_t >& gui::CleanerViewModel::getVisibleItems( ActiveContext context ) const
+{
+	return m_visibleItems[ static_cast< size_t >( context ) ];
+}
+
+const core::Icon& gui::CleanerViewModel::getItemIcon( size_t itemIndex ) const
+{
+	return m_itemIcons[ itemIndex ];
+}
+
+const std::string& gui::CleanerViewModel::getCustomTooltip( size_t optionIndex ) const
+{
+	return optionIndex < m_customTooltips.size() ? m_customTooltips[ optionIndex ] : EMPTY_TOOLTIP;
+}
+
+const gui::ToolbarIcons& gui::CleanerViewModel::getIcons() const noexcept
+{
+	return m_icons;
+}
+
+bool gui::CleanerViewModel::isVisibleIn( const common::CleaningItem& item, ActiveContext context )
+{
+	switch ( context )
+	{
+		case ActiveContext::BROWSER:
+			return item.itemType == common::ItemType::BROWSER;
+		case ActiveContext::TEMP_AND_SYSTEM:
+			return item.itemType == common::ItemType::TEMP || item.itemType == common::ItemType::SYSTEM;
+		case ActiveContext::CUSTOM:
+			return item.itemType == common::ItemType::CUSTOM_PATH;
+		default:
+			return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "common/cleaner_info.hpp"
+#include "common/types.hpp"
+
+#include "core/texture_manager.hpp"
+
+namespace core
+{
+	class SystemCleaner;
+}
+
+namespace gui
+{
+	enum class ActiveContext : size_t
+	{
+		BROWSER,
+		TEMP_AND_SYSTEM,
+		CUSTOM,
+		COUNT
+	};
+
+	struct ToolbarIcons
+	{
+		core::Icon enableAll;
+		core::Icon disableAll;
+		core::Icon addFile;
+		core::Icon addFolder;
+		core::Icon remove;
+	};
+
+	// what the options column draws, resolved when the items change instead of on every frame
+	class CleanerViewModel
+	{
+	public:
+		// resolves the icons, lists the visible items of every tab and the full paths of custom options.
+		// the icons change once more when the texture atlas is uploaded
+		void rebuild( const common::CleaningItems& cleaningItems, core::SystemCleaner& systemCleaner, core::TextureManager& textureManager );
+		void markDirty() noexcept;
+		[[nodiscard]] bool isDirty() const noexcept;
+
+		[[nodiscard]] const std::vector< size_t >& getVisibleItems( ActiveContext context ) const;
+		[[nodiscard]] const core::Icon& getItemIcon( size_t itemIndex ) const;
+		// full path of the custom option at the same position, empty when it is not known
+		[[nodiscard]] const std::string& getCustomTooltip( size_t optionIndex ) const;
+		[[nodiscard]] const ToolbarIcons& getIcons() const noexcept;
+
+	private:
+		[[nodiscard]] static bool isVisibleIn( const common::CleaningItem& item, ActiveContext context );
+
+		std::array< std::vector< size_t >, static_cast< size_t >( ActiveContext::COUNT ) > m_visibleItems;
+		std::vector< core::Icon > m_itemIcons;
+		std::vector< std::string > m_customTooltips;
+		ToolbarIcons m_icons;
+		bool m_isDirty = true;
+	};
+}
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include "title_bar.hpp"
 
 #include <cmath>
+#include <cstdio>
 
 #include "common/scoped_guards.hpp"
 #include "core/window.hpp"
+#include "utils/custom_widgets.hpp"
 
 namespace
 {
@@ -20,11 +22,22 @@ void gui::TitleBar::draw()
 {
 	ImGui::Child titleBar( "TitleBar", ImVec2( 0, TITLE_HEIGHT ) );
 	ImGui::Text( "System Cleaner" );
+	if ( !m_startupTooltip.empty() )
+	{
+		utils::Tooltip( m_startupTooltip.c_str() );
+	}
 	drawButtons();
 
 	draggingWindow();
 }
 
+void gui::TitleBar::setStartupTimes( float firstFrameMs, float interactiveMs )
+{
+	char text[ 96 ];
+	std::snprintf( text, sizeof( text ), "First frame after %.0f ms\nAll items loaded after %.0f ms", firstFrameMs, interactiveMs );
+	m_startupTooltip = text;
+}
+
 void gui::TitleBar::drawButtons()
 {
 	constexpr ImVec2 buttonSize = ImVec2( 20.0f, 0 );
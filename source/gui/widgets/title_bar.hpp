@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include <imgui.h>
 
 namespace core
@@ -22,6 +24,7 @@ namespace gui
 		TitleBar( core::Window& window );
 
 		void draw();
+		void setStartupTimes( float firstFrameMs, float interactiveMs );
 
 	private:
 		void drawButtons();
@@ -30,6 +33,7 @@ namespace gui
 		ImVec2 getCursorScreenPos() const;
 
 		DraggingData m_draggingData;
+		std::string m_startupTooltip;
 		core::Window& m_mainWindow;
 	};
 }
\ No newline at end of file
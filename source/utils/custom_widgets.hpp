@@ -2,6 +2,8 @@
 
 #include <imgui.h>
 
+#include "core/texture_manager.hpp"
+
 namespace utils
 {
 	inline void Tooltip( const char* text )
@@ -11,4 +13,14 @@ namespace utils
 			ImGui::SetTooltip( text );
 		}
 	}
+
+	inline void IconImage( const core::Icon& icon, const ImVec2& size )
+	{
+		ImGui::Image( icon.textureID, size, ImVec2( icon.u0, icon.v0 ), ImVec2( icon.u1, icon.v1 ) );
+	}
+
+	inline bool IconButton( const char* id, const core::Icon& icon, const ImVec2& size )
+	{
+		return ImGui::ImageButton( id, icon.textureID, size, ImVec2( icon.u0, icon.v0 ), ImVec2( icon.u1, icon.v1 ) );
+	}
 }
\ No newline at end of file
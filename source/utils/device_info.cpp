@@ -0,0 +1,81 @@
+#include "device_info.hpp"
+
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif
+
+namespace
+{
+#ifndef _WIN32
+	// a partition has no queue of its own, the flag is read from the disk above it
+	constexpr int MAX_SYSFS_PARENTS = 2;
+#endif
+}
+
+std::optional< bool > utils::isRotational( const fs::path& path )
+{
+#ifdef _WIN32
+	const std::wstring rootName = path.root_name().wstring();
+	if ( rootName.empty() )
+	{
+		return std::nullopt;
+	}
+
+	const std::wstring volumePath = L"\\\\.\\" + rootName;
+	const HANDLE volume = CreateFileW( volumePath.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr );
+	if ( volume == INVALID_HANDLE_VALUE )
+	{
+		return std::nullopt;
+	}
+
+	STORAGE_PROPERTY_QUERY query {};
+	query.PropertyId = StorageDeviceSeekPenaltyProperty;
+	query.QueryType = PropertyStandardQuery;
+
+	DEVICE_SEEK_PENALTY_DESCRIPTOR descriptor {};
+	DWORD bytesReturned = 0;
+	const BOOL success = DeviceIoControl( volume, IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof( query ),
+		&descriptor, sizeof( descriptor ), &bytesReturned, nullptr );
+	CloseHandle( volume );
+
+	if ( !success || bytesReturned < sizeof( descriptor ) )
+	{
+		return std::nullopt;
+	}
+	return descriptor.IncursSeekPenalty != FALSE;
+#else
+	struct stat st {};
+	if ( ::stat( path.c_str(), &st ) != 0 )
+	{
+		return std::nullopt;
+	}
+
+	std::error_code ec;
+	const std::string devicePath = "/sys/dev/block/" + std::to_string( major( st.st_dev ) ) + ":" + std::to_string( minor( st.st_dev ) );
+	fs::path sysfsDir = fs::canonical( devicePath, ec );
+	if ( ec )
+	{
+		return std::nullopt;
+	}
+
+	for ( int i = 0; i <= MAX_SYSFS_PARENTS; ++i, sysfsDir = sysfsDir.parent_path() )
+	{
+		if ( std::ifstream input( sysfsDir / "queue" / "rotational" ); input )
+		{
+			int rotational = 0;
+			if ( input >> rotational )
+			{
+				return rotational != 0;
+			}
+		}
+	}
+	return std::nullopt;
+#endif
+}
\ No newline at end of file
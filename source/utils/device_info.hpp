@@ -0,0 +1,13 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+namespace fs = std::filesystem;
+
+namespace utils
+{
+	// whether the disk holding the path has a seek penalty: queue/rotational in sysfs, the storage seek penalty property on Windows.
+	// nullopt for virtual and network filesystems that report neither
+	[[nodiscard]] std::optional< bool > isRotational( const fs::path& path );
+}
\ No newline at end of file
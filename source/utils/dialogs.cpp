@@ -63,6 +63,11 @@ common::OptionalPath utils::openFolderDialog()
     return openSelectionDialog( "Select folder to clean", DialogType::FOLDER );
 }
 
+common::OptionalPath utils::openPathListDialog()
+{
+    return openSelectionDialog( "Select list of paths to import", DialogType::FILE );
+}
+
 utils::Result utils::openMessageBox( std::string_view title, std::string_view message, ButtonFlag buttons, BoxType type )
 {
     UINT winButtons = 0;
@@ -17,6 +17,7 @@ namespace utils
 
     common::OptionalPath openFileDialog();
     common::OptionalPath openFolderDialog();
+    common::OptionalPath openPathListDialog();
 
     enum ButtonFlag : uint32_t
     {
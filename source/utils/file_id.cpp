@@ -0,0 +1,51 @@
+#include "file_id.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+std::optional< utils::FileId > utils::getFileId( const fs::path& path )
+{
+	const std::optional< FileInfo > info = getFileInfo( path );
+	if ( !info )
+	{
+		return std::nullopt;
+	}
+	return info->id;
+}
+
+std::optional< utils::FileInfo > utils::getFileInfo( const fs::path& path )
+{
+#ifdef _WIN32
+	const HANDLE handle = CreateFileW( path.wstring().c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr );
+	if ( handle == INVALID_HANDLE_VALUE )
+	{
+		return std::nullopt;
+	}
+
+	BY_HANDLE_FILE_INFORMATION info {};
+	const BOOL success = GetFileInformationByHandle( handle, &info );
+	CloseHandle( handle );
+	if ( !success )
+	{
+		return std::nullopt;
+	}
+
+	return FileInfo {
+		.id = { info.dwVolumeSerialNumber, ( static_cast< uint64_t >( info.nFileIndexHigh ) << 32 ) | info.nFileIndexLow },
+		.size = ( static_cast< uint64_t >( info.nFileSizeHigh ) << 32 ) | info.nFileSizeLow };
+#else
+	struct stat st {};
+	if ( ::stat( path.c_str(), &st ) != 0 )
+	{
+		return std::nullopt;
+	}
+
+	return FileInfo {
+		.id = { static_cast< uint64_t >( st.st_dev ), static_cast< uint64_t >( st.st_ino ) },
+		.size = static_cast< uint64_t >( st.st_size ) };
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace fs = std::filesystem;
+
+namespace utils
+{
+	// identity of a file that survives different spellings of its path: volume serial and file index on Windows, st_dev and st_ino elsewhere
+	struct FileId
+	{
+		uint64_t device = 0;
+		uint64_t inode = 0;
+
+		bool operator==( const FileId& other ) const = default;
+	};
+
+	struct FileIdHash
+	{
+		size_t operator()( const FileId& id ) const noexcept
+		{
+			return std::hash< uint64_t >{}( id.inode * 0x9E3779B97F4A7C15ull ^ id.device );
+		}
+	};
+
+	struct FileInfo
+	{
+		FileId id;
+		uint64_t size = 0;
+	};
+
+	[[nodiscard]] std::optional< FileId > getFileId( const fs::path& path );
+	// identity and size from one query, for callers that need both
+	[[nodiscard]] std::optional< FileInfo > getFileInfo( const fs::path& path );
+}
\ No newline at end of file
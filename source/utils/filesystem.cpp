@@ -1,5 +1,7 @@
 #include "filesystem.hpp"
 
+#include <cstdlib>
+
 fs::path utils::FileSystem::getProjectSourceDir() const
 {
 #ifdef PROJECT_SOURCE_DIR
@@ -12,16 +14,53 @@ fs::path utils::FileSystem::getTempDir() const
 	return fs::temp_directory_path();
 }
 
+fs::path utils::FileSystem::getHomeDir() const
+{
+#ifdef _WIN32
+	const char* home = std::getenv( "USERPROFILE" );
+#else
+	const char* home = std::getenv( "HOME" );
+#endif
+	return fs::path( home ? home : "" );
+}
+
 fs::path utils::FileSystem::getLocalAppDataDir() const
 {
+#ifdef _WIN32
 	const char* localAppData = std::getenv( "LOCALAPPDATA" );
-	return fs::path( localAppData );
+	return fs::path( localAppData ? localAppData : "" );
+#else
+	return getXdgDir( "XDG_DATA_HOME", ".local/share" );
+#endif
 }
 
 fs::path utils::FileSystem::getRoamingAppDataDir() const
 {
+#ifdef _WIN32
 	const char* localAppData = std::getenv( "APPDATA" );
-	return fs::path( localAppData );
+	return fs::path( localAppData ? localAppData : "" );
+#else
+	return getXdgDir( "XDG_CONFIG_HOME", ".config" );
+#endif
+}
+
+fs::path utils::FileSystem::getCacheDir() const
+{
+#ifdef _WIN32
+	return getLocalAppDataDir();
+#else
+	return getXdgDir( "XDG_CACHE_HOME", ".cache" );
+#endif
+}
+
+fs::path utils::FileSystem::getXdgDir( const char* variable, std::string_view fallback ) const
+{
+	const char* value = std::getenv( variable );
+	if ( value && fs::path( value ).is_absolute() )
+	{
+		return fs::path( value );
+	}
+	return getHomeDir() / fallback;
 }
 
 fs::path utils::FileSystem::getWindowsDir() const
@@ -30,6 +69,11 @@ fs::path utils::FileSystem::getWindowsDir() const
 	return fs::path( winDir ? winDir : "C:\\Windows" );
 }
 
+fs::path utils::FileSystem::getConfigDir() const
+{
+	return getRoamingAppDataDir() / "SystemCleaner";
+}
+
 fs::path utils::FileSystem::getUpdateCacheDir() const
 {
 	return getWindowsDir() / "SoftwareDistribution" / "Download";
@@ -7,6 +7,12 @@ namespace fs = std::filesystem;
 
 namespace utils
 {
+	inline std::string pathToString( const fs::path& path )
+	{
+		std::u8string u8str = path.u8string();
+		return std::string( reinterpret_cast< const char* >( u8str.c_str() ) );
+	}
+
 	class FileSystem
 	{
 	public:
@@ -19,9 +25,13 @@ namespace utils
 		fs::path getProjectSourceDir() const;
 
 		fs::path getTempDir() const;
+		fs::path getHomeDir() const;
+		// XDG data, config and cache folders outside of Windows
 		fs::path getLocalAppDataDir() const;
 		fs::path getRoamingAppDataDir() const;
+		fs::path getCacheDir() const;
 		fs::path getWindowsDir() const;
+		fs::path getConfigDir() const;
 
 		fs::path getUpdateCacheDir() const;
 		fs::path getLogsDir() const;
@@ -30,6 +40,8 @@ namespace utils
 	private:
 		FileSystem(){}
 
+		fs::path getXdgDir( const char* variable, std::string_view fallback ) const;
+
 		FileSystem& operator=( const FileSystem& ) = delete;
 		FileSystem( const FileSystem& ) = delete;
 
@@ -0,0 +1,117 @@
+#include "glob.hpp"
+
+#include <cwctype>
+
+namespace
+{
+	using Char = fs::path::value_type;
+
+	constexpr Char ANY_SEQUENCE = '*';
+	constexpr Char ANY_CHAR = '?';
+
+	bool equalChars( Char c1, Char c2 )
+	{
+#ifdef _WIN32
+		return std::towlower( c1 ) == std::towlower( c2 );
+#else
+		return c1 == c2;
+#endif
+	}
+
+	bool hasWildcards( const fs::path::string_type& str )
+	{
+		return str.find_first_of( fs::path::string_type { ANY_SEQUENCE, ANY_CHAR } ) != fs::path::string_type::npos;
+	}
+}
+
+bool utils::glob::hasWildcards( const fs::path& pattern )
+{
+	return ::hasWildcards( pattern.native() );
+}
+
+bool utils::glob::match( const fs::path::string_type& pattern, const fs::path::string_type& name )
+{
+	// greedy matching with a single backtrack point for the last '*'
+	size_t p = 0;
+	size_t n = 0;
+	size_t starPos = fs::path::string_type::npos;
+	size_t starMatch = 0;
+
+	while ( n < name.size() )
+	{
+		if ( p < pattern.size() && ( pattern[ p ] == ANY_CHAR || ( pattern[ p ] != ANY_SEQUENCE && equalChars( pattern[ p ], name[ n ] ) ) ) )
+		{
+			++p;
+			++n;
+		}
+		else if ( p < pattern.size() && pattern[ p ] == ANY_SEQUENCE )
+		{
+			starPos = p++;
+			starMatch = n;
+		}
+		else if ( starPos != fs::path::string_type::npos )
+		{
+			p = starPos + 1;
+			n = ++starMatch;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	while ( p < pattern.size() && pattern[ p ] == ANY_SEQUENCE )
+	{
+		++p;
+	}
+	return p == pattern.size();
+}
+
+std::vector< fs::path > utils::glob::expand( const fs::path& pattern )
+{
+	if ( !hasWildcards( pattern ) )
+	{
+		return { pattern };
+	}
+
+	std::vector< fs::path > current { pattern.root_path() };
+	for ( const fs::path& component : pattern.relative_path() )
+	{
+		const fs::path::string_type& name = component.native();
+		if ( name.empty() )
+		{
+			continue;
+		}
+
+		std::vector< fs::path > next;
+		std::error_code ec;
+		for ( const fs::path& base : current )
+		{
+			if ( !::hasWildcards( name ) )
+			{
+				next.push_back( base / component );
+				continue;
+			}
+
+			try
+			{
+				for ( const fs::directory_entry& entry : fs::directory_iterator( base.empty() ? fs::path( "." ) : base, fs::directory_options::skip_permission_denied, ec ) )
+				{
+					if ( match( name, entry.path().filename().native() ) )
+					{
+						next.push_back( base / entry.path().filename() );
+					}
+				}
+			}
+			catch ( const fs::filesystem_error& ) {}
+		}
+		current = std::move( next );
+	}
+
+	std::erase_if( current, [] ( const fs::path& path )
+	{
+		std::error_code ec;
+		return !fs::exists( path, ec );
+	} );
+	return current;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace utils::glob
+{
+	[[nodiscard]] bool hasWildcards( const fs::path& pattern );
+
+	// '*' and '?' are allowed in any component, matching is case-insensitive on Windows
+	[[nodiscard]] bool match( const fs::path::string_type& pattern, const fs::path::string_type& name );
+
+	// existing paths matching the pattern, the pattern itself when it has no wildcards
+	[[nodiscard]] std::vector< fs::path > expand( const fs::path& pattern );
+}
\ No newline at end of file
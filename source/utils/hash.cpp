@@ -0,0 +1,146 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+namespace
+{
+	constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ull;
+
+	constexpr uint64_t rotateLeft( uint64_t value, int bits )
+	{
+		return ( value << bits ) | ( value >> ( 64 - bits ) );
+	}
+
+	// the format is little-endian, memcpy keeps unaligned reads legal
+	inline uint64_t read64( const uint8_t* data )
+	{
+		uint64_t value;
+		std::memcpy( &value, data, sizeof( value ) );
+		return value;
+	}
+
+	inline uint32_t read32( const uint8_t* data )
+	{
+		uint32_t value;
+		std::memcpy( &value, data, sizeof( value ) );
+		return value;
+	}
+
+	constexpr uint64_t round( uint64_t accumulator, uint64_t input )
+	{
+		accumulator += input * PRIME_2;
+		accumulator = rotateLeft( accumulator, 31 );
+		return accumulator * PRIME_1;
+	}
+
+	constexpr uint64_t mergeRound( uint64_t accumulator, uint64_t lane )
+	{
+		accumulator ^= round( 0, lane );
+		return accumulator * PRIME_1 + PRIME_4;
+	}
+
+	inline void processStripes( std::array< uint64_t, 4 >& lanes, const uint8_t* data, size_t count )
+	{
+		uint64_t lane0 = lanes[ 0 ], lane1 = lanes[ 1 ], lane2 = lanes[ 2 ], lane3 = lanes[ 3 ];
+		for ( size_t i = 0; i < count; ++i, data += 32 )
+		{
+			lane0 = round( lane0, read64( data ) );
+			lane1 = round( lane1, read64( data + 8 ) );
+			lane2 = round( lane2, read64( data + 16 ) );
+			lane3 = round( lane3, read64( data + 24 ) );
+		}
+		lanes = { lane0, lane1, lane2, lane3 };
+	}
+}
+
+utils::Hash64::Hash64( uint64_t seed ) : m_seed( seed ),
+	m_lanes { seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1 }
+{
+}
+
+void utils::Hash64::update( const void* data, size_t size )
+{
+	const uint8_t* bytes = static_cast< const uint8_t* >( data );
+	m_totalSize += size;
+
+	if ( m_bufferSize > 0 )
+	{
+		const size_t toCopy = std::min( size, STRIPE_SIZE - m_bufferSize );
+		std::memcpy( m_buffer.data() + m_bufferSize, bytes, toCopy );
+		m_bufferSize += toCopy;
+		bytes += toCopy;
+		size -= toCopy;
+
+		if ( m_bufferSize < STRIPE_SIZE )
+		{
+			return;
+		}
+		processStripes( m_lanes, m_buffer.data(), 1 );
+		m_bufferSize = 0;
+	}
+
+	const size_t stripes = size / STRIPE_SIZE;
+	processStripes( m_lanes, bytes, stripes );
+	bytes += stripes * STRIPE_SIZE;
+	size -= stripes * STRIPE_SIZE;
+
+	std::memcpy( m_buffer.data(), bytes, size );
+	m_bufferSize = size;
+}
+
+uint64_t utils::Hash64::digest() const
+{
+	uint64_t hash;
+	if ( m_totalSize >= STRIPE_SIZE )
+	{
+		hash = rotateLeft( m_lanes[ 0 ], 1 ) + rotateLeft( m_lanes[ 1 ], 7 ) + rotateLeft( m_lanes[ 2 ], 12 ) + rotateLeft( m_lanes[ 3 ], 18 );
+		for ( const uint64_t lane : m_lanes )
+		{
+			hash = mergeRound( hash, lane );
+		}
+	}
+	else
+	{
+		hash = m_seed + PRIME_5;
+	}
+	hash += m_totalSize;
+
+	const uint8_t* data = m_buffer.data();
+	const uint8_t* end = data + m_bufferSize;
+	for ( ; data + 8 <= end; data += 8 )
+	{
+		hash ^= round( 0, read64( data ) );
+		hash = rotateLeft( hash, 27 ) * PRIME_1 + PRIME_4;
+	}
+
+	if ( data + 4 <= end )
+	{
+		hash ^= static_cast< uint64_t >( read32( data ) ) * PRIME_1;
+		hash = rotateLeft( hash, 23 ) * PRIME_2 + PRIME_3;
+		data += 4;
+	}
+
+	for ( ; data < end; ++data )
+	{
+		hash ^= *data * PRIME_5;
+		hash = rotateLeft( hash, 11 ) * PRIME_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME_2;
+	hash ^= hash >> 29;
+	hash *= PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+uint64_t utils::hash64( const void* data, size_t size, uint64_t seed )
+{
+	Hash64 hash( seed );
+	hash.update( data, size );
+	return hash.digest();
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace utils
+{
+	// streaming XXH64. four independent lanes are mixed per 32-byte stripe, which the compiler keeps in vector registers
+	class Hash64
+	{
+	public:
+		explicit Hash64( uint64_t seed = 0 );
+
+		void update( const void* data, size_t size );
+		[[nodiscard]] uint64_t digest() const;
+
+	private:
+		static constexpr size_t STRIPE_SIZE = 32;
+
+		uint64_t m_seed;
+		uint64_t m_totalSize = 0;
+		std::array< uint64_t, 4 > m_lanes;
+		std::array< uint8_t, STRIPE_SIZE > m_buffer {};
+		size_t m_bufferSize = 0;
+	};
+
+	[[nodiscard]] uint64_t hash64( const void* data, size_t size, uint64_t seed = 0 );
+}
\ No newline at end of file
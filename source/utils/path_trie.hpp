@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cwctype>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace utils
+{
+	// prefix tree over path components, callers are expected to pass canonical paths
+	template< typename Value >
+	class PathTrie
+	{
+	public:
+		struct Match
+		{
+			const Value* value = nullptr;
+			bool exact = false;
+		};
+
+		void insert( const fs::path& path, Value value )
+		{
+			std::vector< Node* > nodes { &m_root };
+			for ( const fs::path::string_type& key : split( path ) )
+			{
+				std::unique_ptr< Node >& child = nodes.back()->children[ key ];
+				if ( !child )
+				{
+					child = std::make_unique< Node >();
+				}
+				nodes.push_back( child.get() );
+			}
+
+			Node* node = nodes.back();
+			if ( !node->value )
+			{
+				for ( Node* visited : nodes )
+				{
+					++visited->valueCount;
+				}
+			}
+			node->value = std::move( value );
+		}
+
+		bool erase( const fs::path& path )
+		{
+			std::vector< Node* > nodes { &m_root };
+			for ( const fs::path::string_type& key : split( path ) )
+			{
+				auto it = nodes.back()->children.find( key );
+				if ( it == nodes.back()->children.end() )
+				{
+					return false;
+				}
+				nodes.push_back( it->second.get() );
+			}
+
+			if ( !nodes.back()->value )
+			{
+				return false;
+			}
+
+			nodes.back()->value.reset();
+			for ( Node* visited : nodes )
+			{
+				--visited->valueCount;
+			}
+			return true;
+		}
+
+		// deepest value stored at the path itself or at one of its ancestors
+		[[nodiscard]] Match findClosest( const fs::path& path ) const
+		{
+			Match match;
+			const Node* node = &m_root;
+			const std::vector< fs::path::string_type > keys = split( path );
+			for ( size_t i = 0; i < keys.size(); ++i )
+			{
+				auto it = node->children.find( keys[ i ] );
+				if ( it == node->children.end() )
+				{
+					return match;
+				}
+
+				node = it->second.get();
+				if ( node->value )
+				{
+					match = { &*node->value, i + 1 == keys.size() };
+				}
+			}
+			return match;
+		}
+
+		// any value stored strictly below the path
+		[[nodiscard]] const Value* findDescendant( const fs::path& path ) const
+		{
+			const Node* node = &m_root;
+			for ( const fs::path::string_type& key : split( path ) )
+			{
+				auto it = node->children.find( key );
+				if ( it == node->children.end() )
+				{
+					return nullptr;
+				}
+				node = it->second.get();
+			}
+
+			if ( node->valueCount <= ( node->value ? 1u : 0u ) )
+			{
+				return nullptr;
+			}
+
+			// counters lead straight to the nearest stored value
+			while ( true )
+			{
+				for ( const auto& [ key, child ] : node->children )
+				{
+					if ( child->valueCount > 0 )
+					{
+						node = child.get();
+						break;
+					}
+				}
+
+				if ( node->value )
+				{
+					return &*node->value;
+				}
+			}
+		}
+
+		void clear()
+		{
+			m_root = Node {};
+		}
+
+		[[nodiscard]] static std::vector< fs::path::string_type > split( const fs::path& path )
+		{
+			std::vector< fs::path::string_type > keys;
+			for ( const fs::path& component : path.lexically_normal() )
+			{
+				fs::path::string_type key = component.native();
+				if ( key.empty() )
+				{
+					continue;
+				}
+#ifdef _WIN32
+				for ( auto& ch : key )
+				{
+					ch = static_cast< wchar_t >( std::towlower( ch ) );
+				}
+#endif
+				keys.push_back( std::move( key ) );
+			}
+			return keys;
+		}
+
+	private:
+		struct Node
+		{
+			std::unordered_map< fs::path::string_type, std::unique_ptr< Node > > children;
+			std::optional< Value > value;
+			size_t valueCount = 0;
+		};
+
+		Node m_root;
+	};
+}
\ No newline at end of file
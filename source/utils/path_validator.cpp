@@ -1,130 +1,262 @@
 #include "path_validator.hpp"
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
 
 #include <array>
 
 #include "utils/filesystem.hpp"
+#include "utils/path_trie.hpp"
 
 namespace
 {
-	constexpr std::array< std::string_view, 7 > SYSTEM_FOLDERS = 
-	{
-		"System32",
-		"SysWOW64",
-		"WinSxS",
-		"assembly",
-		"Microsoft.NET",
-		"boot",
-		"SystemResources"
+	enum class Rule
+	{
+		ALLOW,		// cleanable even inside a protected subtree
+		EXACT,		// the folder itself is protected, its content is not
+		SUBTREE		// the folder and everything below it is protected
+	};
+
+	struct ProtectedRoot
+	{
+		Rule rule = Rule::SUBTREE;
+		std::string_view message;
 	};
 
+	constexpr std::string_view SYSTEM_FOLDER = "System folder";
+	constexpr std::string_view PROGRAM_FOLDER = "Program Files folder";
+	constexpr std::string_view HOME_FOLDER = "Cannot select home folder";
+
+#ifdef _WIN32
 	constexpr std::array< std::string_view, 3 > PROGRAM_FOLDERS =
 	{
 		"Program Files",
 		"Program Files (x86)",
 		"ProgramData"
 	};
-	
+
 	constexpr DWORD PROTECTED_ATTR = FILE_ATTRIBUTE_SYSTEM | FILE_ATTRIBUTE_HIDDEN;
+#else
+	constexpr std::array< std::string_view, 16 > SYSTEM_FOLDERS =
+	{
+		"/bin",
+		"/boot",
+		"/dev",
+		"/etc",
+		"/lib",
+		"/lib32",
+		"/lib64",
+		"/libx32",
+		"/opt",
+		"/proc",
+		"/run",
+		"/sbin",
+		"/srv",
+		"/sys",
+		"/usr",
+		"/var/lib"
+	};
+
+	constexpr std::array< std::string_view, 7 > CONTAINER_FOLDERS =
+	{
+		"/home",
+		"/media",
+		"/mnt",
+		"/root",
+		"/var",
+		"/var/cache",
+		"/var/log"
+	};
+#endif
 
-	bool isWindowsSystemFolder( const fs::path& path )
+	// protected roots are canonicalized once, afterwards every check is a walk down the trie
+	class ProtectedPaths
 	{
-		const fs::path windowsDir = utils::FileSystem::instance().getWindowsDir();
-		if ( fs::equivalent( path, windowsDir ) )
+	public:
+		[[nodiscard]] static const ProtectedPaths& instance()
 		{
-			return true;
+			static const ProtectedPaths protectedPaths;
+			return protectedPaths;
 		}
 
-		try
+		[[nodiscard]] common::OptionalString find( const fs::path& path ) const
 		{
-			const fs::path relativePath = fs::relative( path, windowsDir );
-			if ( !relativePath.empty() && relativePath.string().rfind( "..", 0 ) != 0 )
+			const utils::PathTrie< ProtectedRoot >::Match match = m_trie.findClosest( path );
+			if ( !match.value || match.value->rule == Rule::ALLOW || ( match.value->rule == Rule::EXACT && !match.exact ) )
 			{
-				return true;
+				return std::nullopt;
 			}
+			return std::string( match.value->message );
 		}
-		catch ( const std::exception& ) {}
 
-		for ( std::string_view systemFolder : SYSTEM_FOLDERS )
+	private:
+		ProtectedPaths()
 		{
-			const fs::path sysPath = windowsDir / systemFolder;
-			if ( fs::exists( sysPath ) && fs::equivalent( sysPath, path ) )
+#ifdef _WIN32
+			const utils::FileSystem& fileSystem = utils::FileSystem::instance();
+			const fs::path windowsDir = fileSystem.getWindowsDir();
+			add( windowsDir, Rule::SUBTREE, "Windows system folder" );
+			add( fileSystem.getTempDir(), Rule::ALLOW );
+			add( windowsDir / "Temp", Rule::ALLOW );
+			add( fileSystem.getUpdateCacheDir(), Rule::ALLOW );
+			add( fileSystem.getLogsDir(), Rule::ALLOW );
+			add( fileSystem.getPrefetchDir(), Rule::ALLOW );
+
+			const fs::path diskPath = windowsDir.root_path();
+			for ( std::string_view programFolder : PROGRAM_FOLDERS )
 			{
-				return true;
+				add( diskPath / programFolder, Rule::SUBTREE, PROGRAM_FOLDER );
 			}
-		}
-
-		return false;
-	}
 
-	bool isWindowsProgramFiles( const fs::path& path )
-	{
-		const fs::path diskPath = utils::FileSystem::instance().getWindowsDir().parent_path();
-		for ( std::string_view programFolder : PROGRAM_FOLDERS )
-		{
-			const fs::path progPath = diskPath / programFolder;
-			if ( fs::exists( progPath ) && fs::equivalent( diskPath, progPath ) )
+			if ( const char* userProfile = std::getenv( "USERPROFILE" ) )
 			{
-				return true;
+				add( userProfile, Rule::EXACT, HOME_FOLDER );
+			}
+#else
+			for ( std::string_view systemFolder : SYSTEM_FOLDERS )
+			{
+				add( systemFolder, Rule::SUBTREE, SYSTEM_FOLDER );
 			}
 
-			try
+			for ( std::string_view containerFolder : CONTAINER_FOLDERS )
 			{
-				const fs::path relative = fs::relative( path, progPath );
-				if ( !relative.empty() && relative.string().rfind( "..", 0 ) != 0 )
-				{
-					return true;
-				}
+				add( containerFolder, Rule::EXACT, SYSTEM_FOLDER );
+			}
+			add( "/var/tmp", Rule::ALLOW );
 
+			if ( const char* home = std::getenv( "HOME" ) )
+			{
+				add( home, Rule::EXACT, HOME_FOLDER );
 			}
-			catch ( const std::exception& )
+#endif
+		}
+
+		// both spellings are stored, so /lib and /usr/lib are caught by the lexical lookup already
+		void add( const fs::path& path, Rule rule, std::string_view message = {} )
+		{
+			const fs::path normalized = path.lexically_normal();
+			m_trie.insert( normalized, { rule, message } );
+
+			std::error_code ec;
+			const fs::path canonicalPath = fs::weakly_canonical( normalized, ec );
+			if ( !ec && canonicalPath != normalized )
 			{
-				continue;
+				m_trie.insert( canonicalPath, { rule, message } );
 			}
 		}
 
-		return false;
-	}
+		utils::PathTrie< ProtectedRoot > m_trie;
+	};
 
-	bool isProtectedByAttributes( const fs::path& path )
+	struct PathStatus
 	{
+		bool exists = false;
+		bool isLink = false;
+		bool hasProtectedAttributes = false;
+	};
+
+	// the single stat of a check
+	PathStatus queryStatus( const fs::path& path )
+	{
+		PathStatus status;
+#ifdef _WIN32
 		const DWORD attrs = GetFileAttributesW( path.wstring().c_str() );
-		if ( attrs == INVALID_FILE_ATTRIBUTES )
+		if ( attrs != INVALID_FILE_ATTRIBUTES )
+		{
+			status.exists = true;
+			status.isLink = ( attrs & FILE_ATTRIBUTE_REPARSE_POINT ) != 0;
+			status.hasProtectedAttributes = ( attrs & PROTECTED_ATTR ) != 0;
+		}
+#else
+		struct stat st {};
+		if ( ::lstat( path.c_str(), &st ) == 0 )
 		{
-			return true;
+			status.exists = true;
+			status.isLink = S_ISLNK( st.st_mode );
 		}
+#endif
+		return status;
+	}
 
-		return ( attrs & PROTECTED_ATTR ) != 0;
+	fs::path normalize( const fs::path& path )
+	{
+		std::error_code ec;
+		fs::path absolutePath = fs::absolute( path, ec );
+		return ( ec ? path : absolutePath ).lexically_normal();
+	}
+
+	// a link anywhere on the path, not only the last component, can lead into a protected root, so the resolved
+	// path is looked up as well. only a link as the last component must resolve
+	common::OptionalString checkResolved( const fs::path& path, bool isLink )
+	{
+		std::error_code ec;
+		const fs::path target = fs::weakly_canonical( path, ec );
+		if ( ec )
+		{
+			return isLink ? common::OptionalString( "Cannot resolve link target" ) : std::nullopt;
+		}
+
+		if ( target == path )
+		{
+			return std::nullopt;
+		}
+
+		if ( target.relative_path().empty() )
+		{
+			return "Link points to a drive root";
+		}
+
+		return ProtectedPaths::instance().find( target );
 	}
 }
 
 common::OptionalString utils::path::validate( const fs::path& path )
 {
-	if ( !fs::exists( path ) )
+	const fs::path normalized = normalize( path );
+	const PathStatus status = queryStatus( normalized );
+	if ( !status.exists )
 	{
-		return "Path not found"; 
+		return "Path not found";
 	}
 
-	if ( path == path.root_path() )
+	if ( normalized.relative_path().empty() )
 	{
 		return "Cannot select drive root";
 	}
 
-	if ( isWindowsSystemFolder( path ) )
+	if ( common::OptionalString error = ProtectedPaths::instance().find( normalized ) )
 	{
-		return "Windows system folder";
+		return error;
 	}
 
-	if ( isWindowsProgramFiles( path ) )
+	if ( common::OptionalString error = checkResolved( normalized, status.isLink ) )
 	{
-		return "Program Files folder";
+		return error;
 	}
 
-	if ( isProtectedByAttributes( path ) )
+	if ( status.hasProtectedAttributes )
 	{
 		return "File/Folder has protected system attributes";
 	}
 
 	return std::nullopt;
+}
+
+common::OptionalString utils::path::checkProtected( const fs::path& path )
+{
+	const fs::path normalized = normalize( path );
+	if ( normalized.relative_path().empty() )
+	{
+		return "Drive root";
+	}
+
+	if ( common::OptionalString error = ProtectedPaths::instance().find( normalized ) )
+	{
+		return error;
+	}
+
+	return checkResolved( normalized, queryStatus( normalized ).isLink );
 }
\ No newline at end of file
@@ -4,5 +4,9 @@
 
 namespace utils::path
 {
+	// full check for a path picked by the user
 	[[nodiscard]] common::OptionalString validate( const fs::path& path );
+
+	// protected roots only, cheap enough to run for every cleaned root and link target
+	[[nodiscard]] common::OptionalString checkProtected( const fs::path& path );
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+#include "core/cache_index.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+	// fixtures/cache_index holds one cache per case:
+	// firefox*: cache2/index version 0xA with records of 3 and 5 KB, dirty or written as version 9
+	// blockfile*: Cache_Data/index with 7 entries and 123456 bytes, the version 2 header with 4 and 4096, or a crash flag
+	// simple*: Cache_Data/index-dir/the-real-index with 12 entries and 987654 bytes, or a wrong magic
+	const fs::path FIXTURES = fs::path( FIXTURES_DIR ) / "cache_index";
+
+	class Sandbox
+	{
+	public:
+		Sandbox() : m_root( fs::temp_directory_path() / "systemcleaner_cache_index_test" )
+		{
+			fs::remove_all( m_root );
+			fs::create_directories( m_root );
+		}
+
+		~Sandbox()
+		{
+			std::error_code ec;
+			fs::remove_all( m_root, ec );
+		}
+
+		// git keeps neither write times nor empty folders, so every case gets a copy with the cache folder
+		// created and the index dated before or after it
+		fs::path add( std::string_view caseName, std::string_view fixture, const fs::path& cacheDir, const fs::path& index, bool isIndexCurrent )
+		{
+			const fs::path root = m_root / caseName;
+			if ( !fixture.empty() )
+			{
+				fs::copy( FIXTURES / fixture, root, fs::copy_options::recursive );
+			}
+			fs::create_directories( root / cacheDir );
+
+			const fs::file_time_type now = fs::file_time_type::clock::now();
+			fs::last_write_time( root / cacheDir, now - std::chrono::hours( 1 ) );
+			if ( fs::exists( root / index ) )
+			{
+				fs::last_write_time( root / index, isIndexCurrent ? now : now - std::chrono::hours( 2 ) );
+			}
+			return root;
+		}
+
+	private:
+		fs::path m_root;
+	};
+
+	bool equals( const std::optional< core::DirInfo >& info, uint64_t dirSize, uint64_t countFile )
+	{
+		return info.has_value() && info->dirSize == dirSize && info->countFile == countFile;
+	}
+
+	void testFirefox( Sandbox& sandbox )
+	{
+		const fs::path entries = fs::path( "cache2" ) / "entries";
+		const fs::path index = fs::path( "cache2" ) / "index";
+
+		CHECK( equals( core::readCacheIndex( sandbox.add( "firefox", "firefox", entries, index, true ) / entries ), 8 * 1024, 2 ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "firefox_stale", "firefox", entries, index, false ) / entries ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "firefox_dirty", "firefox_dirty", entries, index, true ) / entries ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "firefox_version_9", "firefox_version_9", entries, index, true ) / entries ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "firefox_missing", "", entries, index, true ) / entries ) );
+	}
+
+	void testBlockFile( Sandbox& sandbox )
+	{
+		const fs::path index = fs::path( "Cache_Data" ) / "index";
+
+		CHECK( equals( core::readCacheIndex( sandbox.add( "blockfile", "blockfile", "Cache_Data", index, true ) ), 123456, 7 ) );
+		CHECK( equals( core::readCacheIndex( sandbox.add( "blockfile_version_2", "blockfile_version_2", "Cache_Data", index, true ) ), 4096, 4 ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "blockfile_crashed", "blockfile_crashed", "Cache_Data", index, true ) ) );
+	}
+
+	void testSimple( Sandbox& sandbox )
+	{
+		const fs::path index = fs::path( "Cache_Data" ) / "index-dir" / "the-real-index";
+
+		CHECK( equals( core::readCacheIndex( sandbox.add( "simple", "simple", "Cache_Data", index, true ) ), 987654, 12 ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "simple_stale", "simple", "Cache_Data", index, false ) ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "simple_bad_magic", "simple_bad_magic", "Cache_Data", index, true ) ) );
+		CHECK( !core::readCacheIndex( sandbox.add( "no_index", "", "Cache_Data", index, true ) ) );
+	}
+}
+
+int main()
+{
+	Sandbox sandbox;
+	testFirefox( sandbox );
+	testBlockFile( sandbox );
+	testSimple( sandbox );
+	return test::failures;
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "app/frame_loop.hpp"
+#include "test_check.hpp"
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	// the window without a window: events are posted from any thread like glfwPostEmptyEvent,
+	// the loop closes after the given time and every drawn frame is timed
+	class HeadlessPlatform : public FrameLoop::Platform
+	{
+	public:
+		HeadlessPlatform( double duration, bool isBusy ) : m_duration( duration ), m_isBusy( isBusy ) {}
+
+		void postEvent()
+		{
+			std::scoped_lock lock( m_mutex );
+			m_isPosted = true;
+			m_event.notify_all();
+		}
+
+		bool shouldClose() override
+		{
+			return getTime() >= m_duration;
+		}
+
+		bool isCollapsed() override
+		{
+			return false;
+		}
+
+		double getTime() override
+		{
+			return std::chrono::duration< double >( clock::now() - m_start ).count();
+		}
+
+		void pollEvents() override
+		{
+			std::scoped_lock lock( m_mutex );
+			m_isPosted = false;
+		}
+
+		void waitEvents() override
+		{
+			waitEvents( m_duration );
+		}
+
+		void waitEvents( double timeout ) override
+		{
+			// never past the end of the run, the loop would otherwise sleep through it
+			const double left = m_duration - getTime();
+			std::unique_lock lock( m_mutex );
+			m_event.wait_for( lock, std::chrono::duration< double >( left < timeout ? left : timeout ), [ this ] { return m_isPosted; } );
+			m_isPosted = false;
+		}
+
+		void drawFrame() override
+		{
+			m_frameTimes.push_back( getTime() );
+		}
+
+		bool isBusy() override
+		{
+			return m_isBusy;
+		}
+
+		const std::vector< double >& getFrameTimes() const
+		{
+			return m_frameTimes;
+		}
+
+	private:
+		const clock::time_point m_start = clock::now();
+		const double m_duration;
+		const bool m_isBusy;
+
+		std::mutex m_mutex;
+		std::condition_variable m_event;
+		bool m_isPosted = false;
+
+		std::vector< double > m_frameTimes;
+	};
+
+	struct LoopStats
+	{
+		size_t frames = 0;
+		double cpuMs = 0.0;
+		double wallMs = 0.0;
+		// mean time between two frames
+		double frameMs = 0.0;
+	};
+
+	LoopStats runLoop( HeadlessPlatform& platform )
+	{
+		const std::clock_t cpuStart = std::clock();
+		const clock::time_point wallStart = clock::now();
+		FrameLoop loop( platform );
+		loop.run();
+
+		const std::vector< double >& frameTimes = platform.getFrameTimes();
+		LoopStats stats;
+		stats.frames = frameTimes.size();
+		stats.cpuMs = 1000.0 * static_cast< double >( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+		stats.wallMs = std::chrono::duration< double, std::milli >( clock::now() - wallStart ).count();
+		if ( frameTimes.size() > 1 )
+		{
+			stats.frameMs = 1000.0 * ( frameTimes.back() - frameTimes.front() ) / static_cast< double >( frameTimes.size() - 1 );
+		}
+		return stats;
+	}
+
+	void print( const char* name, const LoopStats& stats )
+	{
+		std::printf( "%-6s %4zu frames in %6.0f ms, %7.1f ms between frames, cpu %5.1f ms (%.2f%%)\n", name, stats.frames, stats.wallMs,
+			stats.frameMs, stats.cpuMs, 100.0 * stats.cpuMs / stats.wallMs );
+	}
+
+	// without input only the frames after startup and one per idle timeout are drawn, where vsync would draw 60 a second
+	void testIdle()
+	{
+		HeadlessPlatform platform( 3.0, false );
+		const LoopStats stats = runLoop( platform );
+		print( "idle", stats );
+
+		CHECK( stats.frames >= 4 );
+		CHECK( stats.frames <= 7 );
+		CHECK( stats.cpuMs < 0.05 * stats.wallMs );
+	}
+
+	// progress of a run is drawn at about 30 frames a second
+	void testBusy()
+	{
+		HeadlessPlatform platform( 1.0, true );
+		const LoopStats stats = runLoop( platform );
+		print( "busy", stats );
+
+		CHECK( stats.frames >= 20 );
+		CHECK( stats.frames <= 40 );
+	}
+
+	// an event posted by another thread wakes the idle loop at once, it draws a few frames and sleeps again
+	void testWake()
+	{
+		HeadlessPlatform platform( 1.5, false );
+		std::thread poster( [ &platform ] ()
+		{
+			std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+			platform.postEvent();
+		} );
+		const LoopStats stats = runLoop( platform );
+		poster.join();
+		print( "wake", stats );
+
+		size_t framesAfterPost = 0;
+		bool isWokenAtOnce = false;
+		for ( const double time : platform.getFrameTimes() )
+		{
+			framesAfterPost += time >= 0.5 ? 1 : 0;
+			isWokenAtOnce = isWokenAtOnce || ( time >= 0.5 && time < 0.6 );
+		}
+		CHECK( isWokenAtOnce );
+		CHECK( framesAfterPost >= 1 );
+		CHECK( framesAfterPost <= 5 );
+	}
+}
+
+int main()
+{
+	testIdle();
+	testBusy();
+	testWake();
+	return test::failures;
+}
\ No newline at end of file
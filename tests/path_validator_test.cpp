@@ -0,0 +1,67 @@
+#include <filesystem>
+
+#include "test_check.hpp"
+#include "utils/path_validator.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	class Sandbox
+	{
+	public:
+		Sandbox() : m_root( fs::temp_directory_path() / "systemcleaner_path_validator_test" )
+		{
+			fs::remove_all( m_root );
+			fs::create_directories( m_root / "plain" / "sub" );
+			fs::create_directory_symlink( "/usr", m_root / "usr" );
+			fs::create_directory_symlink( "/etc", m_root / "etc" );
+		}
+
+		~Sandbox()
+		{
+			std::error_code ec;
+			fs::remove_all( m_root, ec );
+		}
+
+		const fs::path& root() const
+		{
+			return m_root;
+		}
+
+	private:
+		fs::path m_root;
+	};
+
+	// a link as the last component was always resolved
+	void testLinkedLastComponent( const Sandbox& sandbox )
+	{
+		CHECK( utils::path::validate( sandbox.root() / "usr" ).has_value() );
+		CHECK( utils::path::checkProtected( sandbox.root() / "etc" ).has_value() );
+	}
+
+	// a link in the middle of the path must not lead around the protected roots
+	void testLinkedMiddleComponent( const Sandbox& sandbox )
+	{
+		CHECK( utils::path::validate( sandbox.root() / "usr" / "lib" ).has_value() );
+		CHECK( utils::path::checkProtected( sandbox.root() / "usr" / "lib" ).has_value() );
+		CHECK( utils::path::validate( sandbox.root() / "etc" / "ssl" ).has_value() );
+		CHECK( utils::path::checkProtected( sandbox.root() / "etc" / "ssl" ).has_value() );
+		CHECK( utils::path::checkProtected( sandbox.root() / "usr" / "lib" / "not-there" ).has_value() );
+	}
+
+	void testPlainPath( const Sandbox& sandbox )
+	{
+		CHECK( !utils::path::validate( sandbox.root() / "plain" / "sub" ).has_value() );
+		CHECK( !utils::path::checkProtected( sandbox.root() / "plain" / "sub" ).has_value() );
+	}
+}
+
+int main()
+{
+	Sandbox sandbox;
+	testLinkedLastComponent( sandbox );
+	testLinkedMiddleComponent( sandbox );
+	testPlainPath( sandbox );
+	return test::failures;
+}
\ No newline at end of file
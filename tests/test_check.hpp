@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdio>
+
+// a failed check is reported and the test goes on, main returns the number of failures
+#define CHECK( condition ) \
+	do \
+	{ \
+		if ( !( condition ) ) \
+		{ \
+			std::fprintf( stderr, "%s:%d: CHECK( %s ) failed\n", __FILE__, __LINE__, #condition ); \
+			++test::failures; \
+		} \
+	} while ( false )
+
+namespace test
+{
+	inline int failures = 0;
+}
\ No newline at end of file